@@ -837,6 +837,16 @@ module snitch_cc #(
   // Tracer
   // --------------------------
   // pragma translate_off
+`ifdef SNITCH_TRACE_BINARY
+  // Hand the trace events to the testbench as compact binary records instead
+  // of formatting them here (see `target/common/test/hart_trace.hh`). The
+  // extras vector is wide enough for the largest trace port struct.
+  import "DPI-C" function void snitch_trace_open(input int hart_id, input longint time_scale);
+  import "DPI-C" function void snitch_trace_record(
+    input int hart_id, input int source, input longint time, input longint cycle, input int priv,
+    input int pc, input longint insn, input int words, input bit [64*34-1:0] extras);
+  import "DPI-C" function void snitch_trace_close(input int hart_id);
+`endif
   int f;
   string fn;
   logic [63:0] cycle = 0;
@@ -848,9 +858,14 @@ module snitch_cc #(
     #0;
     /* verilator lint_on STMTDLY */
     $system("mkdir logs -p");
+`ifdef SNITCH_TRACE_BINARY
+    // Record how `%t` scales `$time`, such that the decoded time matches.
+    snitch_trace_open(hart_id_i, $sformatf("%0t", 64'd1).atoi());
+`else
     $sformat(fn, "logs/trace_hart_%05x.dasm", hart_id_i);
     f = $fopen(fn, "w");
     $display("[Tracer] Logging Hart %d to %s", hart_id_i, fn);
+`endif
   end
 
   // verilog_lint: waive-start always-ff-non-blocking
@@ -918,10 +933,15 @@ module snitch_cc #(
       if (
           !i_snitch.stall || i_snitch.retire_load || i_snitch.retire_acc
       ) begin
+`ifdef SNITCH_TRACE_BINARY
+        snitch_trace_record(hart_id_i, snitch_pkg::SrcSnitch, $time, cycle, i_snitch.priv_lvl_q,
+            i_snitch.pc_q, i_snitch.inst_data_i, $bits(extras_snitch) / 64, extras_snitch);
+`else
         $sformat(trace_entry, "%t %1d %8d 0x%h DASM(%h) #; %s\n",
             $time, cycle, i_snitch.priv_lvl_q, i_snitch.pc_q, i_snitch.inst_data_i,
             snitch_pkg::print_snitch_trace(extras_snitch));
         $fwrite(f, trace_entry);
+`endif
       end
       if (FPEn) begin
         // Trace FPU iff:
@@ -931,18 +951,28 @@ module snitch_cc #(
         // OR an FPU result, LSU result or bus value is ready to be written back to an FPR register
         if (extras_fpu.acc_q_hs || extras_fpu.fpu_out_hs
         || extras_fpu.lsu_q_hs || extras_fpu.fpr_we) begin
+`ifdef SNITCH_TRACE_BINARY
+          snitch_trace_record(hart_id_i, snitch_pkg::SrcFpu, $time, cycle, i_snitch.priv_lvl_q,
+              0, extras_fpu.op_in, $bits(extras_fpu) / 64, extras_fpu);
+`else
           $sformat(trace_entry, "%t %1d %8d 0x%h DASM(%h) #; %s\n",
               $time, cycle, i_snitch.priv_lvl_q, 32'hz, extras_fpu.op_in,
               snitch_pkg::print_fpu_trace(extras_fpu));
           $fwrite(f, trace_entry);
+`endif
         end
         // sequencer instructions
         if (Xfrep) begin
           if (extras_fpu_seq_out.cbuf_push) begin
+`ifdef SNITCH_TRACE_BINARY
+            snitch_trace_record(hart_id_i, snitch_pkg::SrcFpuSeq, $time, cycle,
+                i_snitch.priv_lvl_q, 0, 0, $bits(extras_fpu_seq_out) / 64, extras_fpu_seq_out);
+`else
             $sformat(trace_entry, "%t %1d %8d 0x%h DASM(%h) #; %s\n",
                 $time, cycle, i_snitch.priv_lvl_q, 32'hz, 64'hz,
                 snitch_pkg::print_fpu_sequencer_trace(extras_fpu_seq_out));
             $fwrite(f, trace_entry);
+`endif
           end
         end
       end
@@ -952,7 +982,11 @@ module snitch_cc #(
   end
 
   final begin
+`ifdef SNITCH_TRACE_BINARY
+    snitch_trace_close(hart_id_i);
+`else
     $fclose(f);
+`endif
   end
   // verilog_lint: waive-stop always-ff-non-blocking
   // pragma translate_on
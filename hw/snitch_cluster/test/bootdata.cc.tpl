@@ -2,6 +2,7 @@
 // Solderpad Hardware License, Version 0.51, see LICENSE for details.
 // SPDX-License-Identifier: SHL-0.51
 
+#include <dram_model.hh>
 #include <tb_lib.hh>
 
 namespace sim {
@@ -18,4 +19,12 @@ const BootData BOOTDATA = {.boot_addr = ${hex(cfg['cluster']['boot_addr'])},
                            .s1_quadrant_count = ${cfg['nr_s1_quadrant']},
                            .clint_base = ${hex(cfg['peripherals']['clint']['address'])}};
 
+<% timing = cfg['dram']['timing'] %>
+const DramTiming DRAM_TIMING = {.latency = ${timing['latency']},
+                                .row_miss_latency = ${timing['row_miss_latency']},
+                                .bytes_per_cycle = ${float(timing['bytes_per_cycle'])},
+                                .banks = ${timing['banks']},
+                                .row_size = ${timing['row_size']},
+                                .max_outstanding = ${timing['max_outstanding']}};
+
 }  // namespace sim
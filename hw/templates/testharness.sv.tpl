@@ -69,6 +69,7 @@ module testharness import ${cfg["cluster"]["name"]}_pkg::*; (
     .AxiDataWidth ( WideDataWidth   ),
     .AxiIdWidth   ( WideIdWidthOut  ),
     .AxiUserWidth ( WideUserWidth   ),
+    .DramPort     ( 1               ),
     .req_t        ( wide_out_req_t  ),
     .rsp_t        ( wide_out_resp_t )
   ) i_dma (
@@ -87,16 +87,15 @@ static inline void linear_layer(const linear_layer_t *l) {
     float *result = ptr;
     ptr += ofmap_size;
 
-    // now we DMA transfer the weights and bias into the cluster TCDM
-    if (snrt_is_dm_core()) {
-        snrt_dma_txid_t txid_bias = snrt_dma_start_1d(bias, l->bias, bias_size);
-        snrt_dma_txid_t txid_weights = snrt_dma_start_2d(
-            weights, l->weights, l->CO * sizeof(float), l->CO * sizeof(float),
-            l->CO * sizeof(float), l->CI * sizeof(float));
+    // The weights and bias are shared by all clusters, so they are read from
+    // main memory once and forwarded between the cluster TCDMs
+    snrt_global_broadcast(weights, l->weights, weights_size, 0);
+    snrt_global_broadcast(bias, l->bias, bias_size, 0);
 
+    if (snrt_is_dm_core()) {
         snrt_dma_txid_t txid_ifmap = snrt_dma_start_2d(
             ifmap, l->ifmap, l->CH * sizeof(float), l->CH * sizeof(float),
-            l->CH * sizeof(float), l->CW * sizeof(float));
+            l->CH * sizeof(float), l->CW);
 
         snrt_dma_wait_all();
     }
@@ -131,7 +130,7 @@ static inline void linear_layer(const linear_layer_t *l) {
     if (snrt_is_dm_core()) {
         snrt_dma_txid_t txid_result = snrt_dma_start_2d(
             result, l->result, l->CH * sizeof(float), l->CH * sizeof(float),
-            l->CH * sizeof(float), l->CO * sizeof(float));
+            l->CH * sizeof(float), l->CO);
         snrt_dma_wait_all();
     }
 
@@ -32,8 +32,9 @@ int main() {
     }
 
     // Use snrt_l1alloc() to allocate a chunk of memory in the cluster-private
-    // TCMD L1 scratchpad memory. Free is currently not possible. Store the
-    // pointer in a static variable that is shared amongst the cluster cores
+    // TCMD L1 scratchpad memory. Memory is freed by popping an arena opened
+    // with snrt_l1_arena_push(). Store the pointer in a static variable that
+    // is shared amongst the cluster cores
     static void* p;
     if (core_idx == 0) {
         p = snrt_l1alloc(1024);
@@ -9,16 +9,43 @@ typedef struct {
     uint32_t size;
     // Address of the next allocated block
     uint32_t next;
+    // Highest value `next` has reached
+    uint32_t high_water;
 } snrt_allocator_t;
 
+// Allocation state saved by `snrt_l1_arena_push`
+typedef struct {
+    uint32_t next;
+} snrt_l1_arena_t;
+
 inline void *snrt_l1_next();
 
 inline void *snrt_l3_next();
 
 inline void *snrt_l1alloc(size_t size);
 
+inline void *snrt_l1alloc_aligned(size_t size, size_t alignment);
+
+inline void *snrt_l1alloc_bank(size_t size, uint32_t bank);
+
+inline snrt_l1_arena_t snrt_l1_arena_push();
+
+inline void snrt_l1_arena_pop(snrt_l1_arena_t arena);
+
+inline size_t snrt_l1_available();
+
+inline size_t snrt_l1_high_water_mark();
+
 inline void snrt_l1_update_next(void *next);
 
 inline void *snrt_l3alloc(size_t size);
 
 inline void snrt_alloc_init();
+
+inline void snrt_core_memset(void *ptr, uint8_t value, size_t num);
+
+inline void snrt_core_memcpy(void *dst, const void *src, size_t num);
+
+inline void *snrt_memset(void *ptr, int value, size_t num);
+
+inline void *snrt_memcpy(void *dst, const void *src, size_t num);
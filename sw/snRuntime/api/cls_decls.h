@@ -2,9 +2,13 @@
 // Licensed under the Apache License, Version 2.0, see LICENSE for details.
 // SPDX-License-Identifier: Apache-2.0
 
+#include "sync_decls.h"
+
 typedef struct {
     uint32_t hw_barrier;
     snrt_allocator_t l1_allocator;
+    snrt_tree_barrier_t global_barrier;
+    snrt_collective_state_t collective;
 } cls_t;
 
 inline cls_t* cls();
@@ -0,0 +1,27 @@
+// Copyright 2024 KU Leuven.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+/// A DMA transfer identifier.
+typedef uint32_t snrt_dma_txid_t;
+
+inline snrt_dma_txid_t snrt_dma_start_1d(void *dst, const void *src,
+                                         size_t size);
+
+inline snrt_dma_txid_t snrt_dma_start_2d(void *dst, const void *src,
+                                         size_t size, size_t dst_stride,
+                                         size_t src_stride, size_t repeat);
+
+inline snrt_dma_txid_t snrt_dma_start_nd(void *dst, const void *src,
+                                         size_t size, uint32_t dims,
+                                         const size_t *repeat,
+                                         const size_t *dst_stride,
+                                         const size_t *src_stride);
+
+inline snrt_dma_txid_t snrt_dma_start_memset(void *ptr, uint8_t value,
+                                             size_t size);
+
+inline snrt_dma_txid_t snrt_dma_start_memcpy(void *dst, const void *src,
+                                             size_t size);
+
+inline void snrt_dma_wait(snrt_dma_txid_t tid);
@@ -0,0 +1,58 @@
+// Copyright 2024 KU Leuven.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+/// Most L1 buffers per operand of a DMA pipeline. The DM core keeps the ID of
+/// the last transfer into every buffer on its stack.
+#ifndef SNRT_DMA_PIPE_MAX_DEPTH
+#define SNRT_DMA_PIPE_MAX_DEPTH 8
+#endif
+
+/// An operand of a DMA pipeline, tiled along the pipeline's iteration space.
+/// A tile is `size` contiguous bytes, repeated `repeat[0]` times every
+/// `stride[0]` bytes, and all that `repeat[1]` times every `stride[1]` bytes
+/// in main memory. Set unused repeats to 1 (or 0) for 1D and 2D tiles. In L1,
+/// tiles are stored densely.
+typedef struct {
+    // Tile 0 in main memory
+    void *l3;
+    // Offset between successive tiles in main memory
+    size_t tile_stride;
+    // Shape of a tile in main memory
+    size_t size;
+    size_t stride[2];
+    size_t repeat[2];
+    // Written back once a tile is computed, rather than loaded before
+    uint32_t output;
+    // First of the `depth` L1 tile buffers, set by `snrt_dma_pipe_run`
+    void *buf;
+} snrt_dma_pipe_operand_t;
+
+typedef struct snrt_dma_pipe snrt_dma_pipe_t;
+
+/// A DMA pipeline: the DM core loads the inputs of upcoming tiles and writes
+/// back the outputs of computed tiles while the compute cores run `compute`
+/// on the current tile. The descriptor must be cluster-private.
+struct snrt_dma_pipe {
+    snrt_dma_pipe_operand_t *operands;
+    uint32_t num_operands;
+    uint32_t num_tiles;
+    // Number of L1 buffers per operand, clamped to
+    // `[2, SNRT_DMA_PIPE_MAX_DEPTH]`
+    uint32_t depth;
+    // Called on every compute core for every tile
+    void (*compute)(snrt_dma_pipe_t *pipe, uint32_t tile, void *arg);
+    void *arg;
+    // Cycles per stage, measured by the DM core and the first compute core
+    uint32_t dma_issue_cycles;
+    uint32_t dma_wait_cycles;
+    uint32_t compute_cycles;
+    uint32_t sync_cycles;
+};
+
+inline size_t snrt_dma_pipe_tile_bytes(const snrt_dma_pipe_operand_t *op);
+
+inline void *snrt_dma_pipe_buffer(const snrt_dma_pipe_t *pipe,
+                                  uint32_t operand, uint32_t tile);
+
+inline void snrt_dma_pipe_run(snrt_dma_pipe_t *pipe);
@@ -5,7 +5,7 @@
 typedef struct {
     uint32_t workers_in_loop;
     uint32_t exit_flag;
-    uint32_t workers_mutex;
+    snrt_ticket_mutex_t workers_mutex;
     uint32_t workers_wfi;
     struct {
         void (*fn)(void *, uint32_t);  // points to microtask wrapper
@@ -0,0 +1,65 @@
+// Copyright 2024 KU Leuven.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+/// Events the profiler can count, at most `SNRT_PERF_N_CNT` per group
+#define SNRT_PROF_MAX_EVENTS 64
+
+/// Bytes of records the profiler buffer holds
+#define SNRT_PROF_BUFFER_BYTES 16384
+
+/// Characters of a region name kept in a record
+#define SNRT_PROF_NAME_LEN 12
+
+/// Regions a hart can nest. Deeper regions are not recorded.
+#define SNRT_PROF_MAX_DEPTH 4
+
+/// Identifies an initialized profiler buffer ("PROF")
+#define SNRT_PROF_MAGIC 0x464f5250
+
+/// An event counted by the profiler. `hart` is the cluster-local hart whose
+/// events are counted, and is ignored for cluster-global events.
+typedef struct {
+    uint8_t type;
+    uint8_t hart;
+} snrt_prof_event_t;
+
+/// A region instance of a hart, followed by one counter per event of its
+/// group. Counters are the deltas over the region once it is closed.
+typedef struct {
+    char name[SNRT_PROF_NAME_LEN];
+    uint16_t hart;
+    uint8_t group;
+    uint8_t closed;
+    uint32_t cycles;
+    uint32_t counter[];
+} snrt_prof_record_t;
+
+/// The profiler buffer, shared by all clusters and decoded on the host by
+/// `util/trace/prof_csv.py`. Group `g` counts the events `g *
+/// SNRT_PERF_N_CNT` onwards.
+typedef struct {
+    uint32_t magic;
+    uint32_t max_events;
+    uint32_t num_events;
+    uint32_t capacity;
+    // Bytes of records reserved so far, may exceed the capacity
+    uint32_t volatile used;
+    // Records which did not fit into the buffer
+    uint32_t volatile dropped;
+    snrt_prof_event_t event[SNRT_PROF_MAX_EVENTS];
+    uint32_t data[SNRT_PROF_BUFFER_BYTES / sizeof(uint32_t)];
+} snrt_prof_buffer_t;
+
+extern snrt_prof_buffer_t snrt_prof_buffer;
+
+inline void snrt_prof_init(const snrt_prof_event_t *events,
+                           uint32_t num_events);
+
+inline uint32_t snrt_prof_num_groups();
+
+inline void snrt_prof_select_group(uint32_t group);
+
+inline void snrt_prof_begin(const char *name);
+
+inline void snrt_prof_end();
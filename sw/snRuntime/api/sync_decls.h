@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 
 typedef struct {
@@ -11,6 +12,107 @@ typedef struct {
     uint32_t volatile iteration;
 } snrt_barrier_t;
 
+/// Waiters of a ticket mutex which spin on distinct TCDM words, a power of two
+/// no smaller than the number of cores of a cluster
+#define SNRT_TICKET_MUTEX_SLOTS 16
+
+/// Ticket mutex. Waiters take a ticket and spin on the slot of their ticket,
+/// which the previous holder writes on release. All-zero is unlocked.
+typedef struct {
+    // Next ticket to hand out
+    uint32_t volatile next;
+    // Ticket of the current holder
+    uint32_t volatile owner;
+    // Ticket allowed to enter, per slot. Slots are a TCDM bank apart.
+    struct {
+        uint32_t volatile ticket;
+        uint32_t reserved;
+    } slot[SNRT_TICKET_MUTEX_SLOTS];
+} snrt_ticket_mutex_t;
+
+/// Queue node of a core in an MCS mutex
+typedef struct snrt_mcs_node {
+    struct snrt_mcs_node *volatile next;
+    uint32_t volatile locked;
+} snrt_mcs_node_t;
+
+/// MCS mutex for the cores of a cluster. Waiters queue up behind the tail,
+/// and each spins on its own node until its predecessor hands over the
+/// mutex. All-zero is unlocked.
+typedef struct {
+    snrt_mcs_node_t *volatile tail;
+    snrt_mcs_node_t node[SNRT_CLUSTER_CORE_NUM];
+} snrt_mcs_mutex_t;
+
+/// Clusters synchronized by one node of the global barrier tree. The first
+/// level of the tree matches the clusters of a quadrant.
+#ifndef SNRT_BARRIER_ARITY
+#define SNRT_BARRIER_ARITY 4
+#endif
+
+/// Depth of the global barrier tree. With more clusters than it covers, the
+/// flat barrier is used.
+#define SNRT_BARRIER_MAX_LEVELS 4
+#define SNRT_BARRIER_MAX_CLUSTERS                                   \
+    (SNRT_BARRIER_ARITY * SNRT_BARRIER_ARITY * SNRT_BARRIER_ARITY * \
+     SNRT_BARRIER_ARITY)
+
+/// A cluster's node of the global barrier tree, in its cluster-local storage.
+typedef struct {
+    // Sense of the current barrier, flipped by every barrier
+    uint32_t sense;
+    // Written by the children of each level led by this cluster on arrival
+    uint32_t volatile arrive[SNRT_BARRIER_MAX_LEVELS][SNRT_BARRIER_ARITY];
+    // Written by the parent to release this cluster
+    uint32_t volatile release;
+} snrt_tree_barrier_t;
+
+/// Element types of the reduction collectives
+typedef enum {
+    SNRT_FP64,
+    SNRT_FP32,
+    SNRT_FP16,
+    SNRT_INT32,
+} snrt_dtype_t;
+
+/// Operators of the reduction collectives
+typedef enum {
+    SNRT_REDUCE_SUM,
+    SNRT_REDUCE_MAX,
+    SNRT_REDUCE_MIN,
+} snrt_reduce_op_t;
+
+/// Algorithms of the global reduction
+typedef enum {
+    // Picked by buffer size, see `snrt_global_reduction_algorithm`
+    SNRT_REDUCE_AUTO,
+    // Binary tree, one level at a time
+    SNRT_REDUCE_TREE,
+    // Chain through all clusters towards cluster 0, pipelined across them
+    SNRT_REDUCE_RING,
+} snrt_reduce_alg_t;
+
+/// Bytes the reductions work on at a time, a multiple of 8. The DMA transfers
+/// the next chunk while the compute cores reduce the current one.
+#ifndef SNRT_REDUCE_CHUNK_BYTES
+#define SNRT_REDUCE_CHUNK_BYTES 2048
+#endif
+
+/// Bytes a broadcast copies at a time. A cluster forwards every chunk as
+/// soon as it arrived.
+#ifndef SNRT_BCAST_CHUNK_BYTES
+#define SNRT_BCAST_CHUNK_BYTES 4096
+#endif
+
+/// State of the collectives in the cluster-local storage.
+typedef struct {
+    // Chunks this cluster made available to others in ring reductions and
+    // broadcasts, polled by the clusters which pull them
+    uint32_t volatile progress;
+    // L1 chunk buffers, shared by the DM core with the compute cores
+    void *volatile buf;
+} snrt_collective_state_t;
+
 extern volatile uint32_t _snrt_mutex;
 extern volatile snrt_barrier_t _snrt_barrier;
 extern volatile uint32_t _reduction_result;
@@ -23,6 +125,53 @@ inline void snrt_mutex_ttas_acquire(volatile uint32_t *pmtx);
 
 inline void snrt_mutex_release(volatile uint32_t *pmtx);
 
+inline void snrt_mutex_ticket_acquire(volatile snrt_ticket_mutex_t *mtx);
+
+inline void snrt_mutex_ticket_release(volatile snrt_ticket_mutex_t *mtx);
+
+inline void snrt_mutex_mcs_acquire(volatile snrt_mcs_mutex_t *mtx);
+
+inline void snrt_mutex_mcs_release(volatile snrt_mcs_mutex_t *mtx);
+
 inline void snrt_cluster_hw_barrier();
 
+inline void snrt_global_flat_barrier();
+
+inline snrt_tree_barrier_t *snrt_global_barrier_node(uint32_t cluster);
+
+inline void snrt_global_tree_barrier();
+
 inline void snrt_global_barrier();
+
+inline size_t snrt_dtype_size(snrt_dtype_t type);
+
+inline void snrt_reduce_words(void *dst, const void *a, const void *b,
+                              uint32_t words, snrt_dtype_t type,
+                              snrt_reduce_op_t op);
+
+inline void snrt_reduce_tail(void *dst, const void *a, const void *b,
+                             size_t bytes, snrt_dtype_t type,
+                             snrt_reduce_op_t op);
+
+inline void snrt_cluster_reduce(void *dst, const void *a, const void *b,
+                                size_t len, snrt_dtype_t type,
+                                snrt_reduce_op_t op);
+
+inline snrt_reduce_alg_t snrt_global_reduction_algorithm(size_t bytes);
+
+inline void snrt_global_reduction(void *dst, const void *src, size_t len,
+                                  snrt_dtype_t type, snrt_reduce_op_t op,
+                                  snrt_reduce_alg_t alg);
+
+inline void *snrt_cluster_ptr(const void *ptr, uint32_t cluster);
+
+inline void snrt_global_broadcast(void *dst, const void *src, size_t size,
+                                  uint32_t root);
+
+inline void snrt_global_scatter(void *dst, const void *src, size_t size,
+                                uint32_t root);
+
+inline void snrt_global_gather(void *dst, const void *src, size_t size,
+                               uint32_t root);
+
+inline void snrt_global_all_gather(void *dst, const void *src, size_t size);
@@ -7,9 +7,24 @@ snrt_allocator_t l3_allocator;
 extern void *snrt_l1_next();
 extern void *snrt_l3_next();
 
+extern void *snrt_l1_claim(uint32_t addr, size_t size);
 extern void *snrt_l1alloc(size_t size);
+extern void *snrt_l1alloc_aligned(size_t size, size_t alignment);
+extern void *snrt_l1alloc_bank(size_t size, uint32_t bank);
 extern void *snrt_l3alloc(size_t size);
 
+extern snrt_l1_arena_t snrt_l1_arena_push();
+extern void snrt_l1_arena_pop(snrt_l1_arena_t arena);
+
+extern size_t snrt_l1_available();
+extern size_t snrt_l1_high_water_mark();
+
 extern void snrt_l1_update_next(void *next);
 
 extern void snrt_alloc_init();
+
+extern void snrt_core_memset(void *ptr, uint8_t value, size_t num);
+extern void snrt_core_memcpy(void *dst, const void *src, size_t num);
+
+extern void *snrt_memset(void *ptr, int value, size_t num);
+extern void *snrt_memcpy(void *dst, const void *src, size_t num);
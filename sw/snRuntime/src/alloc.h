@@ -7,6 +7,21 @@
 
 #define MIN_CHUNK_SIZE 8
 
+/**
+ * @brief With SNRT_L1ALLOC_CHECK, every L1 allocation is checked against the
+ * end of the allocatable region, i.e. the bottom of the stacks. An allocation
+ * which does not fit is reported and returns a null pointer. Without it, an
+ * allocation is a pointer bump and overflows silently into the stacks. Debug
+ * builds (`DEBUG=ON`, which defines SNRT_DEBUG) enable the check.
+ */
+#if defined(SNRT_DEBUG) && !defined(SNRT_L1ALLOC_CHECK)
+#define SNRT_L1ALLOC_CHECK
+#endif
+
+#ifdef SNRT_L1ALLOC_CHECK
+#include "printf.h"
+#endif
+
 extern snrt_allocator_t l3_allocator;
 
 inline snrt_allocator_t *snrt_l1_allocator() {
@@ -19,32 +34,112 @@ inline void *snrt_l1_next() { return (void *)snrt_l1_allocator()->next; }
 
 inline void *snrt_l3_next() { return (void *)snrt_l3_allocator()->next; }
 
+/**
+ * @brief Reserve `size` bytes of L1 memory from address `addr` onwards
+ * @details `addr` must not lie below the next free address. Updates the
+ * high-water mark and, with SNRT_L1ALLOC_CHECK, checks the bounds.
+ */
+inline void *snrt_l1_claim(uint32_t addr, size_t size) {
+    snrt_allocator_t *alloc = snrt_l1_allocator();
+    uint32_t next = addr + size;
+
+#ifdef SNRT_L1ALLOC_CHECK
+    if (next > alloc->base + alloc->size || next < addr) {
+        printf(
+            "[alloc] Not enough L1 memory to allocate %#x bytes: base %#x size "
+            "%#x next %#x\n",
+            size, alloc->base, alloc->size, alloc->next);
+        return 0;
+    }
+#endif
+
+    alloc->next = next;
+    if (next > alloc->high_water) alloc->high_water = next;
+    return (void *)addr;
+}
+
 /**
  * @brief Allocate a chunk of memory in the L1 memory
- * @details This currently does not support free-ing of memory
+ * @details Memory is released by popping an enclosing arena, see
+ * `snrt_l1_arena_push`. The allocator is shared by all cores of a cluster and
+ * is not thread-safe: a single core allocates and shares the pointers.
  *
  * @param size number of bytes to allocate
  * @return pointer to the allocated memory
  */
 inline void *snrt_l1alloc(size_t size) {
-    snrt_allocator_t *alloc = snrt_l1_allocator();
-
     // TODO colluca: do we need this? What does it imply?
     //               one more instruction, TCDM consumption...
     size = ALIGN_UP(size, MIN_CHUNK_SIZE);
 
-    // TODO colluca
-    // if (alloc->next + size > alloc->base + alloc->size) {
-    //     snrt_trace(
-    //         SNRT_TRACE_ALLOC,
-    //         "Not enough memory to allocate: base %#x size %#x next %#x\n",
-    //         alloc->base, alloc->size, alloc->next);
-    //     return 0;
-    // }
+    return snrt_l1_claim(snrt_l1_allocator()->next, size);
+}
 
-    void *ret = (void *)alloc->next;
-    alloc->next += size;
-    return ret;
+/**
+ * @brief Allocate a chunk of memory in the L1 memory with a given alignment
+ *
+ * @param size number of bytes to allocate
+ * @param alignment alignment in bytes, a power of two
+ * @return pointer to the allocated memory
+ */
+inline void *snrt_l1alloc_aligned(size_t size, size_t alignment) {
+    if (alignment < MIN_CHUNK_SIZE) alignment = MIN_CHUNK_SIZE;
+    uint32_t addr = ALIGN_UP(snrt_l1_allocator()->next, alignment);
+    return snrt_l1_claim(addr, ALIGN_UP(size, MIN_CHUNK_SIZE));
+}
+
+/**
+ * @brief Allocate a chunk of memory in the L1 memory starting in a given bank
+ * @details Placing buffers which are accessed in lockstep, e.g. the operands
+ * of a kernel streamed by SSRs, in different banks avoids bank conflicts
+ * between them. The gap to the requested bank is left unused.
+ *
+ * @param size number of bytes to allocate
+ * @param bank index of the TCDM bank the chunk starts in
+ * @return pointer to the allocated memory
+ */
+inline void *snrt_l1alloc_bank(size_t size, uint32_t bank) {
+    uint32_t addr = ALIGN_UP(snrt_l1_allocator()->next, SNRT_TCDM_BANK_WIDTH);
+    uint32_t current = (addr / SNRT_TCDM_BANK_WIDTH) % SNRT_TCDM_BANK_NUM;
+    uint32_t gap = (bank + SNRT_TCDM_BANK_NUM - current) % SNRT_TCDM_BANK_NUM;
+    addr += gap * SNRT_TCDM_BANK_WIDTH;
+    return snrt_l1_claim(addr, ALIGN_UP(size, MIN_CHUNK_SIZE));
+}
+
+/**
+ * @brief Open a scoped arena in the L1 memory
+ * @details All L1 allocations made until the matching `snrt_l1_arena_pop`
+ * are released by it. Arenas nest like a stack, e.g. a kernel can allocate
+ * its scratch buffers in an arena and return them to its caller on exit.
+ *
+ * @return the allocation state to restore with `snrt_l1_arena_pop`
+ */
+inline snrt_l1_arena_t snrt_l1_arena_push() {
+    snrt_l1_arena_t arena = {snrt_l1_allocator()->next};
+    return arena;
+}
+
+/**
+ * @brief Release all L1 allocations made since `arena` was pushed
+ */
+inline void snrt_l1_arena_pop(snrt_l1_arena_t arena) {
+    snrt_l1_allocator()->next = arena.next;
+}
+
+/**
+ * @brief Number of bytes of L1 memory still available for allocation
+ */
+inline size_t snrt_l1_available() {
+    snrt_allocator_t *alloc = snrt_l1_allocator();
+    return alloc->base + alloc->size - alloc->next;
+}
+
+/**
+ * @brief Largest number of bytes of L1 memory allocated at any time
+ */
+inline size_t snrt_l1_high_water_mark() {
+    snrt_allocator_t *alloc = snrt_l1_allocator();
+    return alloc->high_water - alloc->base;
 }
 
 /**
@@ -53,6 +148,7 @@ inline void *snrt_l1alloc(size_t size) {
 inline void snrt_l1_update_next(void *next) {
     snrt_allocator_t *alloc = snrt_l1_allocator();
     alloc->next = (uint32_t)next;
+    if (alloc->next > alloc->high_water) alloc->high_water = alloc->next;
 }
 
 /**
@@ -76,24 +172,72 @@ inline void snrt_alloc_init() {
     // Only one core per cluster has to initialize the L1 allocator
     if (snrt_is_dm_core()) {
         // Initialize L1 allocator
-        // Note: at the moment the allocator assumes all of the TCDM is
-        // available for allocation. However, the CLS, TLS and stack already
-        // occupy a possibly significant portion.
+        // The CLS sits at the top of the TCDM, followed by the return value
+        // and the (misaligned) stacks of all cores, which hold the TLS.
+        // Everything below is available for allocation.
+        uint32_t stacks = snrt_cluster_core_num() *
+                          ((1 << SNRT_LOG2_STACK_SIZE) + MIN_CHUNK_SIZE);
+        uint32_t end = ALIGN_DOWN((uint32_t)cls() - 8 - stacks, MIN_CHUNK_SIZE);
         snrt_l1_allocator()->base =
             ALIGN_UP(snrt_l1_start_addr(), MIN_CHUNK_SIZE);
-        snrt_l1_allocator()->size = snrt_l1_end_addr() - snrt_l1_start_addr();
+        snrt_l1_allocator()->size = end - snrt_l1_allocator()->base;
         snrt_l1_allocator()->next = snrt_l1_allocator()->base;
+        snrt_l1_allocator()->high_water = snrt_l1_allocator()->base;
         // Initialize L3 allocator
         extern uint32_t _edram;
         snrt_l3_allocator()->base = ALIGN_UP((uint32_t)&_edram, MIN_CHUNK_SIZE);
         snrt_l3_allocator()->size = 0;
         snrt_l3_allocator()->next = snrt_l3_allocator()->base;
+        snrt_l3_allocator()->high_water = snrt_l3_allocator()->base;
+    }
+}
+
+/**
+ * @brief Fill memory with stores of the calling core, a word at a time
+ */
+inline void snrt_core_memset(void *ptr, uint8_t value, size_t num) {
+    uint8_t *p = (uint8_t *)ptr, *end = p + num;
+    uint32_t word = value * 0x01010101u;
+    while (p < end && ((uint32_t)p & 3)) *p++ = value;
+    for (; p + 4 <= end; p += 4) *(uint32_t *)p = word;
+    while (p < end) *p++ = value;
+}
+
+/**
+ * @brief Copy memory with loads and stores of the calling core, a word at a
+ * time if source and destination are equally aligned
+ */
+inline void snrt_core_memcpy(void *dst, const void *src, size_t num) {
+    uint8_t *d = (uint8_t *)dst, *end = d + num;
+    const uint8_t *s = (const uint8_t *)src;
+    if ((((uint32_t)d ^ (uint32_t)s) & 3) == 0) {
+        while (d < end && ((uint32_t)d & 3)) *d++ = *s++;
+        for (; d + 4 <= end; d += 4, s += 4)
+            *(uint32_t *)d = *(const uint32_t *)s;
     }
+    while (d < end) *d++ = *s++;
 }
 
-// TODO colluca: optimize by using DMA
+/**
+ * @brief Fill memory, with the DMA on the DM core and with stores on the
+ * compute cores
+ */
 inline void *snrt_memset(void *ptr, int value, size_t num) {
-    for (uint32_t i = 0; i < num; ++i)
-        *((uint8_t *)ptr + i) = (unsigned char)value;
+    if (snrt_is_dm_core())
+        snrt_dma_wait(snrt_dma_start_memset(ptr, (uint8_t)value, num));
+    else
+        snrt_core_memset(ptr, (uint8_t)value, num);
     return ptr;
 }
+
+/**
+ * @brief Copy memory, with the DMA on the DM core and with loads and stores
+ * on the compute cores
+ */
+inline void *snrt_memcpy(void *dst, const void *src, size_t num) {
+    if (snrt_is_dm_core())
+        snrt_dma_wait(snrt_dma_start_memcpy(dst, src, num));
+    else
+        snrt_core_memcpy(dst, src, num);
+    return dst;
+}
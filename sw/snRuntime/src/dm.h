@@ -30,8 +30,8 @@
 // Macros
 //================================================================================
 
-#define _dm_mtx_lock() snrt_mutex_acquire(&dm_p->mutex)
-#define _dm_mtx_release() snrt_mutex_release(&dm_p->mutex)
+#define _dm_mtx_lock() snrt_mutex_ticket_acquire(&dm_p->mutex)
+#define _dm_mtx_release() snrt_mutex_ticket_release(&dm_p->mutex)
 
 /**
  * Returns of the dm status call
@@ -93,7 +93,7 @@ typedef struct {
     uint32_t queue_back;
     uint32_t queue_front;
     volatile uint32_t queue_fill;
-    volatile uint32_t mutex;
+    snrt_ticket_mutex_t mutex;
     volatile en_stat_t stat_q;
     volatile uint32_t stat_p;
     volatile uint32_t stat_pvalid;
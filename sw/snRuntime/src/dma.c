@@ -17,6 +17,20 @@ extern snrt_dma_txid_t snrt_dma_start_2d(void *dst, const void *src,
                                          size_t size, size_t dst_stride,
                                          size_t src_stride, size_t repeat);
 
+extern snrt_dma_txid_t snrt_dma_start_nd(void *dst, const void *src,
+                                         size_t size, uint32_t dims,
+                                         const size_t *repeat,
+                                         const size_t *dst_stride,
+                                         const size_t *src_stride);
+
+extern snrt_dma_txid_t snrt_dma_start_memset(void *ptr, uint8_t value,
+                                             size_t size);
+
+extern snrt_dma_txid_t snrt_dma_start_memcpy(void *dst, const void *src,
+                                             size_t size);
+
+extern void snrt_dma_memset(void *ptr, uint8_t value, uint32_t len);
+
 extern void snrt_dma_wait(snrt_dma_txid_t tid);
 
 extern void snrt_dma_wait_all();
@@ -2,8 +2,11 @@
 // Licensed under the Apache License, Version 2.0, see LICENSE for details.
 // SPDX-License-Identifier: Apache-2.0
 
-/// A DMA transfer identifier.
-typedef uint32_t snrt_dma_txid_t;
+/// Bytes transferred per beat of the 512-bit DMA data bus.
+#define SNRT_DMA_BEAT_BYTES 64
+
+/// Maximum number of outer dimensions of `snrt_dma_start_nd`.
+#define SNRT_DMA_MAX_DIMS 8
 
 /// Initiate an asynchronous 1D DMA transfer with wide 64-bit pointers.
 inline snrt_dma_txid_t snrt_dma_start_1d_wideptr(uint64_t dst, uint64_t src,
@@ -139,6 +142,74 @@ inline snrt_dma_txid_t snrt_dma_start_2d(void *dst, const void *src,
                                      src_stride, repeat);
 }
 
+/**
+ * @brief Initiate an asynchronous N-dimensional DMA transfer
+ * @details Moves `size` contiguous bytes, repeated over `dims` outer
+ * dimensions with dimension 0 the innermost. Dimension `i` repeats all
+ * dimensions inside it `repeat[i]` times, `dst_stride[i]` and `src_stride[i]`
+ * bytes apart. Dimensions which are contiguous with the ones inside them are
+ * merged. The dimension with the most repetitions is then handed to the
+ * hardware as the 2D repetition, and the remaining ones are iterated over by
+ * the core, issuing as few hardware transfers as possible.
+ *
+ * @return ID of the last transfer, -1 if nothing was transferred or `dims`
+ * exceeds SNRT_DMA_MAX_DIMS
+ */
+inline snrt_dma_txid_t snrt_dma_start_nd(void *dst, const void *src,
+                                         size_t size, uint32_t dims,
+                                         const size_t *repeat,
+                                         const size_t *dst_stride,
+                                         const size_t *src_stride) {
+    size_t rep[SNRT_DMA_MAX_DIMS], dstr[SNRT_DMA_MAX_DIMS],
+        sstr[SNRT_DMA_MAX_DIMS], idx[SNRT_DMA_MAX_DIMS];
+    uint32_t n = 0;
+
+    if (dims > SNRT_DMA_MAX_DIMS) return -1;
+
+    // Merge contiguous dimensions and drop single repetitions
+    for (uint32_t i = 0; i < dims; i++) {
+        if (repeat[i] == 0) return -1;
+        if (repeat[i] == 1) continue;
+        if (n == 0 && dst_stride[i] == size && src_stride[i] == size) {
+            size *= repeat[i];
+        } else if (n > 0 && dst_stride[i] == rep[n - 1] * dstr[n - 1] &&
+                   src_stride[i] == rep[n - 1] * sstr[n - 1]) {
+            rep[n - 1] *= repeat[i];
+        } else {
+            rep[n] = repeat[i];
+            dstr[n] = dst_stride[i];
+            sstr[n] = src_stride[i];
+            idx[n] = 0;
+            n++;
+        }
+    }
+    if (n == 0) return snrt_dma_start_1d(dst, src, size);
+
+    // Hand the dimension with the most repetitions to the hardware
+    uint32_t hw = 0;
+    for (uint32_t i = 1; i < n; i++)
+        if (rep[i] > rep[hw]) hw = i;
+
+    // Iterate over all other dimensions
+    uint8_t *d = (uint8_t *)dst;
+    const uint8_t *s = (const uint8_t *)src;
+    while (1) {
+        snrt_dma_txid_t txid =
+            snrt_dma_start_2d(d, s, size, dstr[hw], sstr[hw], rep[hw]);
+        uint32_t i = 0;
+        for (; i < n; i++) {
+            if (i == hw) continue;
+            d += dstr[i];
+            s += sstr[i];
+            if (++idx[i] < rep[i]) break;
+            d -= rep[i] * dstr[i];
+            s -= rep[i] * sstr[i];
+            idx[i] = 0;
+        }
+        if (i == n) return txid;
+    }
+}
+
 /// Block until a transfer finishes.
 inline void snrt_dma_wait(snrt_dma_txid_t tid) {
     // dmstati t0, 0  # 2=status.completed_id
@@ -185,23 +256,74 @@ inline void snrt_dma_start_tracking() { asm volatile("dmstati zero, 1"); }
 inline void snrt_dma_stop_tracking() { asm volatile("dmstati zero, 3"); }
 
 /**
- * @brief fast memset function performed by DMA
+ * @brief Initiate an asynchronous memset of any size and alignment
+ * @details The DMA fills the bulk of the region in whole bus beats. Zeros are
+ * read from the cluster's zero memory, any other value from a beat seeded by
+ * the core. The head and tail of the region which do not fill a beat, and
+ * regions too small to be worth a transfer, are set by the core.
  *
  * @param ptr pointer to the start of the region
  * @param value value to set
- * @param len number of bytes, must be multiple of DMA bus-width
+ * @param size number of bytes
+ * @return ID of the last transfer, to pass to `snrt_dma_wait`
  */
-inline void snrt_dma_memset(void *ptr, uint8_t value, uint32_t len) {
-    // set first 64bytes to value
-    // memset(ptr, value, 64);
-    uint8_t *p = ptr;
-    uint32_t nbytes = 64;
-    while (nbytes--) {
-        *p++ = value;
+inline snrt_dma_txid_t snrt_dma_start_memset(void *ptr, uint8_t value,
+                                             size_t size) {
+    if (size < 2 * SNRT_DMA_BEAT_BYTES) {
+        snrt_core_memset(ptr, value, size);
+        return -1;
+    }
+
+    uint8_t *bulk = (uint8_t *)ALIGN_UP((uint32_t)ptr, SNRT_DMA_BEAT_BYTES);
+    size_t head = bulk - (uint8_t *)ptr;
+    size_t beats = (size - head) / SNRT_DMA_BEAT_BYTES;
+    size_t tail = size - head - beats * SNRT_DMA_BEAT_BYTES;
+    snrt_core_memset(ptr, value, head);
+    snrt_core_memset(bulk + beats * SNRT_DMA_BEAT_BYTES, value, tail);
+
+    // A seeded beat must leave at least one beat for the DMA to copy it to,
+    // as the DMA never completes a 2D transfer without repetitions
+    if (value && beats < 2) {
+        snrt_core_memset(bulk, value, beats * SNRT_DMA_BEAT_BYTES);
+        return -1;
+    }
+
+    const void *seed = (const void *)snrt_zero_memory_ptr();
+    if (value) {
+        snrt_core_memset(bulk, value, SNRT_DMA_BEAT_BYTES);
+        // Make sure the seed is in memory before the DMA reads it
+        asm volatile("fence" ::: "memory");
+        seed = bulk;
+        bulk += SNRT_DMA_BEAT_BYTES;
+        beats--;
+    }
+    return snrt_dma_start_2d(bulk, seed, SNRT_DMA_BEAT_BYTES,
+                             SNRT_DMA_BEAT_BYTES, 0, beats);
+}
+
+/**
+ * @brief Initiate an asynchronous memcpy of any size and alignment
+ * @details The DMA realigns misaligned source and destination addresses by
+ * itself. Copies smaller than a bus beat are done by the core.
+ *
+ * @return ID of the transfer, to pass to `snrt_dma_wait`
+ */
+inline snrt_dma_txid_t snrt_dma_start_memcpy(void *dst, const void *src,
+                                             size_t size) {
+    if (size < SNRT_DMA_BEAT_BYTES) {
+        snrt_core_memcpy(dst, src, size);
+        return -1;
     }
+    return snrt_dma_start_1d(dst, src, size);
+}
 
-    // DMA copy the the rest
-    snrt_dma_txid_t memset_txid =
-        snrt_dma_start_2d(ptr, ptr, 64, 64, 0, len / 64);
-    snrt_dma_wait_all();
+/**
+ * @brief fast memset function performed by DMA
+ *
+ * @param ptr pointer to the start of the region
+ * @param value value to set
+ * @param len number of bytes
+ */
+inline void snrt_dma_memset(void *ptr, uint8_t value, uint32_t len) {
+    snrt_dma_wait(snrt_dma_start_memset(ptr, value, len));
 }
@@ -0,0 +1,17 @@
+// Copyright 2024 KU Leuven.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+extern size_t snrt_dma_pipe_tile_bytes(const snrt_dma_pipe_operand_t *op);
+
+extern void *snrt_dma_pipe_buffer(const snrt_dma_pipe_t *pipe,
+                                  uint32_t operand, uint32_t tile);
+
+extern snrt_dma_txid_t snrt_dma_pipe_transfer(const snrt_dma_pipe_t *pipe,
+                                              uint32_t tile, uint32_t output);
+
+extern void snrt_dma_pipe_dm(snrt_dma_pipe_t *pipe);
+
+extern void snrt_dma_pipe_compute(snrt_dma_pipe_t *pipe);
+
+extern void snrt_dma_pipe_run(snrt_dma_pipe_t *pipe);
@@ -0,0 +1,150 @@
+// Copyright 2024 KU Leuven.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @brief Size of a tile of `op` in L1
+ */
+inline size_t snrt_dma_pipe_tile_bytes(const snrt_dma_pipe_operand_t *op) {
+    return op->size * op->repeat[0] * op->repeat[1];
+}
+
+/**
+ * @brief L1 buffer holding the tile `tile` of operand `operand`
+ */
+inline void *snrt_dma_pipe_buffer(const snrt_dma_pipe_t *pipe,
+                                  uint32_t operand, uint32_t tile) {
+    const snrt_dma_pipe_operand_t *op = &pipe->operands[operand];
+    return (uint8_t *)op->buf +
+           (tile % pipe->depth) * snrt_dma_pipe_tile_bytes(op);
+}
+
+/**
+ * @brief Start the transfers of all input (or output) tiles `tile`
+ * @return ID of the last transfer, -1 if there was none
+ */
+inline snrt_dma_txid_t snrt_dma_pipe_transfer(const snrt_dma_pipe_t *pipe,
+                                              uint32_t tile, uint32_t output) {
+    snrt_dma_txid_t txid = -1;
+    for (uint32_t i = 0; i < pipe->num_operands; i++) {
+        const snrt_dma_pipe_operand_t *op = &pipe->operands[i];
+        if (op->output != output) continue;
+        uint8_t *l3 = (uint8_t *)op->l3 + tile * op->tile_stride;
+        uint8_t *l1 = snrt_dma_pipe_buffer(pipe, i, tile);
+        size_t dense[2] = {op->size, op->size * op->repeat[0]};
+        snrt_dma_txid_t last;
+        if (output)
+            last = snrt_dma_start_nd(l3, l1, op->size, 2, op->repeat,
+                                     op->stride, dense);
+        else
+            last = snrt_dma_start_nd(l1, l3, op->size, 2, op->repeat, dense,
+                                     op->stride);
+        if (last != (snrt_dma_txid_t)-1) txid = last;
+    }
+    return txid;
+}
+
+/**
+ * @brief DM core side of `snrt_dma_pipe_run`
+ * @details Tile `k` is computed between the barriers `k` and `k + 1`. In the
+ * meantime, the DM core writes back tile `k - 1` and loads the inputs of tile
+ * `k + depth - 1` into the buffers it frees. Before barrier `k`, it waits for
+ * the transfers into the buffers of tile `k`, which the DMA completes in
+ * order.
+ */
+inline void snrt_dma_pipe_dm(snrt_dma_pipe_t *pipe) {
+    uint32_t depth = pipe->depth, n = pipe->num_tiles;
+    snrt_dma_txid_t txid[SNRT_DMA_PIPE_MAX_DEPTH];
+    uint32_t start;
+
+    // The tile buffers are released once the pipeline drained
+    snrt_l1_arena_t arena = snrt_l1_arena_push();
+    for (uint32_t i = 0; i < pipe->num_operands; i++) {
+        snrt_dma_pipe_operand_t *op = &pipe->operands[i];
+        if (!op->repeat[0]) op->repeat[0] = 1;
+        if (!op->repeat[1]) op->repeat[1] = 1;
+        op->buf = snrt_l1alloc_aligned(depth * snrt_dma_pipe_tile_bytes(op),
+                                       SNRT_DMA_BEAT_BYTES);
+    }
+    pipe->dma_issue_cycles = 0;
+    pipe->dma_wait_cycles = 0;
+
+    start = snrt_mcycle();
+    for (uint32_t k = 0; k < depth; k++)
+        txid[k] = k + 1 < depth && k < n ? snrt_dma_pipe_transfer(pipe, k, 0)
+                                         : (snrt_dma_txid_t)-1;
+    pipe->dma_issue_cycles += snrt_mcycle() - start;
+
+    for (uint32_t k = 0; k <= n; k++) {
+        start = snrt_mcycle();
+        snrt_dma_wait(txid[k % depth]);
+        pipe->dma_wait_cycles += snrt_mcycle() - start;
+
+        snrt_cluster_hw_barrier();
+
+        start = snrt_mcycle();
+        snrt_dma_txid_t last = -1;
+        if (k > 0) last = snrt_dma_pipe_transfer(pipe, k - 1, 1);
+        if (k + depth - 1 < n) {
+            snrt_dma_txid_t in = snrt_dma_pipe_transfer(pipe, k + depth - 1, 0);
+            if (in != (snrt_dma_txid_t)-1) last = in;
+        }
+        txid[(k + depth - 1) % depth] = last;
+        pipe->dma_issue_cycles += snrt_mcycle() - start;
+    }
+
+    start = snrt_mcycle();
+    snrt_dma_wait_all();
+    pipe->dma_wait_cycles += snrt_mcycle() - start;
+    snrt_cluster_hw_barrier();
+    snrt_l1_arena_pop(arena);
+}
+
+/**
+ * @brief Compute core side of `snrt_dma_pipe_run`
+ */
+inline void snrt_dma_pipe_compute(snrt_dma_pipe_t *pipe) {
+    int measure = snrt_cluster_core_idx() == 0;
+    uint32_t start = snrt_mcycle(), compute = 0, sync = 0;
+
+    for (uint32_t k = 0; k < pipe->num_tiles; k++) {
+        snrt_cluster_hw_barrier();
+        uint32_t ready = snrt_mcycle();
+        sync += ready - start;
+        pipe->compute(pipe, k, pipe->arg);
+        start = snrt_mcycle();
+        compute += start - ready;
+    }
+    // Wait for the last write-back
+    snrt_cluster_hw_barrier();
+    snrt_cluster_hw_barrier();
+    sync += snrt_mcycle() - start;
+
+    if (measure) {
+        pipe->compute_cycles = compute;
+        pipe->sync_cycles = sync;
+    }
+}
+
+/**
+ * @brief Run a tiled kernel with its transfers overlapped with computation
+ * @details Must be called by all cores of the cluster. The DM core allocates
+ * `depth` L1 buffers per operand, prefetches the inputs of up to
+ * `depth - 1` tiles ahead and writes back outputs behind the compute cores,
+ * which call `compute` on one tile at a time and find the operands of tile
+ * `k` with `snrt_dma_pipe_buffer(pipe, operand, k)`. The compute cores are
+ * synchronized with the DM core by one cluster barrier per tile. On return,
+ * all outputs are in main memory and the tile buffers are freed.
+ */
+inline void snrt_dma_pipe_run(snrt_dma_pipe_t *pipe) {
+    // With a single buffer, the inputs of a tile would be loaded while the
+    // tile is computed. Every core clamps the depth before using it.
+    if (pipe->depth < 2) pipe->depth = 2;
+    if (pipe->depth > SNRT_DMA_PIPE_MAX_DEPTH)
+        pipe->depth = SNRT_DMA_PIPE_MAX_DEPTH;
+
+    if (snrt_is_dm_core())
+        snrt_dma_pipe_dm(pipe);
+    else
+        snrt_dma_pipe_compute(pipe);
+}
@@ -142,12 +142,16 @@ inline void eu_print_status() {
 /**
  * @brief Acquires the event unit mutex, exits only on success
  */
-inline void eu_mutex_lock() { snrt_mutex_acquire(&eu_p->workers_mutex); }
+inline void eu_mutex_lock() {
+    snrt_mutex_ticket_acquire(&eu_p->workers_mutex);
+}
 
 /**
  * @brief Releases the acquired mutex
  */
-inline void eu_mutex_release() { snrt_mutex_release(&eu_p->workers_mutex); }
+inline void eu_mutex_release() {
+    snrt_mutex_ticket_release(&eu_p->workers_mutex);
+}
 
 /**
  * Getters
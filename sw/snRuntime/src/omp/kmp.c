@@ -387,6 +387,56 @@ void __kmpc_for_static_fini(ident_t *loc, kmp_int32 globaltid) {
 //================================================================================
 #ifndef OMPSTATIC_NUMTHREADS
 
+/**
+ * @brief Set up a dynamically scheduled loop of `count` iterations
+ * @details All threads of the team call it. The first one to arrive sets up
+ * the loop, once all threads have run out of iterations of the previous loop,
+ * while the others wait for the setup.
+ */
+static void __kmp_dispatch_init(enum sched_type schedule, kmp_int32 lb,
+                                kmp_uint32 count, kmp_int32 st,
+                                kmp_int32 chunk) {
+    omp_team_t *team = omp_get_team(omp_getData());
+    kmp_uint32 epoch = ++team->core_epoch[omp_get_thread_num()];
+    kmp_uint32 claimed = epoch - 1;
+
+    if (__atomic_compare_exchange_n(&team->loop_claimed, &claimed, epoch, 0,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        // With `nowait`, threads may still be in the previous loop
+        if (epoch > 1)
+            while (team->loop_done != team->loop_threads)
+                ;
+
+        enum sched_type kind = SCHEDULE_WITHOUT_MODIFIERS(schedule);
+        kmp_uint32 threads = team->nbThreads;
+        if (chunk <= 0)
+            chunk = kind == kmp_sch_static ? (count + threads - 1) / threads
+                                           : 1;
+        if (chunk <= 0) chunk = 1;
+
+        team->loop_start = lb;
+        team->loop_incr = st;
+        team->loop_count = count;
+        team->loop_chunk = chunk;
+        team->loop_guided = kind == kmp_sch_guided_chunked ||
+                            kind == kmp_sch_guided_iterative_chunked ||
+                            kind == kmp_sch_guided_analytical_chunked ||
+                            kind == kmp_sch_guided_simd;
+        team->loop_threads = threads;
+        team->loop_next = 0;
+        team->loop_done = 0;
+        __atomic_store_n(&team->loop_epoch, epoch, __ATOMIC_RELEASE);
+        KMP_PRINTF(10,
+                   "__kmpc_dispatch_init_4 setup: start %d count %d incr %d "
+                   "chunk %d guided %d\n",
+                   team->loop_start, team->loop_count, team->loop_incr,
+                   team->loop_chunk, team->loop_guided);
+    } else {
+        while (__atomic_load_n(&team->loop_epoch, __ATOMIC_ACQUIRE) != epoch)
+            ;
+    }
+}
+
 /*!
 @ingroup WORK_SHARING
 @{
@@ -401,50 +451,74 @@ void __kmpc_for_static_fini(ident_t *loc, kmp_int32 globaltid) {
 This function prepares the runtime to start a dynamically scheduled for loop,
 saving the loop arguments.
 These functions are all identical apart from the types of the arguments.
+
+Guided schedules are supported next to dynamic ones. Any other schedule is
+dynamic, with one chunk per thread for `kmp_sch_static`.
 */
-// void __kmpc_dispatch_init_4(ident_t *loc, kmp_int32 gtid,
-//                             enum sched_type schedule, kmp_int32 lb,
-//                             kmp_int32 ub, kmp_int32 st, kmp_int32 chunk) {
-//     (void)loc;
-//     (void)gtid;
-//     (void)schedule;
-//     omp_team_t *team = omp_get_team(omp_getData());
-//     // dynLoopInitNoIter(team, lb, ub, st, chunk);
-//     // int core_id = omp_get_thread_num();
-//     eu_mutex_lock();
-//     // if (team->loop_epoch - team->core_epoch[core_id] != 0)
-//     // {
-//     //   eu_mutex_release();
-//     //   team->core_epoch[core_id]++;
-//     //   KMP_PRINTF(10, "__kmpc_dispatch_init_4 core_epoch[%d] =
-//     //   %d\n",core_id,team->core_epoch[core_id]); return;
-//     // }
-
-//     if (!team->loop_is_setup) {
-//         team->loop_is_setup = 1;
-//         team->loop_start = lb;
-//         team->loop_end = ub;
-//         team->loop_incr = st;
-//         team->loop_chunk = chunk;
-//         KMP_PRINTF(
-//             10,
-//             "__kmpc_dispatch_init_4 setup: start %d end %d incr %d chunk
-//             %d\n", team->loop_start, team->loop_end, team->loop_incr,
-//             team->loop_chunk);
-//     }
-//     eu_mutex_release();
-// }
+void __kmpc_dispatch_init_4(ident_t *loc, kmp_int32 gtid,
+                            enum sched_type schedule, kmp_int32 lb,
+                            kmp_int32 ub, kmp_int32 st, kmp_int32 chunk) {
+    (void)loc;
+    (void)gtid;
+    kmp_uint32 count = 0;
+    if (st > 0 && lb <= ub)
+        count = ((kmp_uint32)ub - (kmp_uint32)lb) / st + 1;
+    else if (st < 0 && lb >= ub)
+        count = ((kmp_uint32)lb - (kmp_uint32)ub) / -st + 1;
+    __kmp_dispatch_init(schedule, lb, count, st, chunk);
+}
 
 /*!
 See @ref __kmpc_dispatch_init_4
 */
-// void __kmpc_dispatch_init_4u(ident_t *loc, kmp_int32 gtid,
-//                              enum sched_type schedule, kmp_uint32 lb,
-//                              kmp_uint32 ub, kmp_int32 st, kmp_int32 chunk) {
-//     kmp_int32 ilb = (kmp_int32)lb;
-//     kmp_int32 iub = (kmp_int32)ub;
-//     __kmpc_dispatch_init_4(loc, gtid, schedule, ilb, iub, st, chunk);
-// }
+void __kmpc_dispatch_init_4u(ident_t *loc, kmp_int32 gtid,
+                             enum sched_type schedule, kmp_uint32 lb,
+                             kmp_uint32 ub, kmp_int32 st, kmp_int32 chunk) {
+    (void)loc;
+    (void)gtid;
+    kmp_uint32 count = 0;
+    if (st > 0 && lb <= ub)
+        count = (ub - lb) / st + 1;
+    else if (st < 0 && lb >= ub)
+        count = (lb - ub) / -st + 1;
+    __kmp_dispatch_init(schedule, (kmp_int32)lb, count, st, chunk);
+}
+
+/**
+ * @brief Claim the next chunk of the current dynamically scheduled loop
+ * @details A single atomic addition (`amoadd`) to the iteration counter in
+ * TCDM claims a chunk. Guided chunks are sized after the iterations remaining
+ * before the addition, so concurrent claims still get disjoint chunks.
+ */
+static int __kmp_dispatch_next(kmp_int32 *p_last, kmp_uint32 *p_lb,
+                               kmp_uint32 *p_ub, kmp_int32 *p_st) {
+    omp_team_t *team = omp_get_team(omp_getData());
+    kmp_uint32 count = team->loop_count;
+    kmp_uint32 size = team->loop_chunk;
+
+    if (team->loop_guided) {
+        kmp_uint32 next = team->loop_next;
+        if (next < count && (count - next) / (2 * team->loop_threads) > size)
+            size = (count - next) / (2 * team->loop_threads);
+    }
+
+    kmp_uint32 first =
+        __atomic_fetch_add(&team->loop_next, size, __ATOMIC_RELAXED);
+    if (first >= count) {
+        __atomic_fetch_add(&team->loop_done, 1, __ATOMIC_RELEASE);
+        KMP_PRINTF(10, "__kmpc_dispatch_next_4 done\n");
+        return 0;
+    }
+    kmp_uint32 last = count - first > size ? first + size - 1 : count - 1;
+
+    *p_lb = (kmp_uint32)team->loop_start + first * (kmp_uint32)team->loop_incr;
+    *p_ub = (kmp_uint32)team->loop_start + last * (kmp_uint32)team->loop_incr;
+    *p_st = team->loop_incr;
+    if (p_last != NULL) *p_last = last == count - 1;
+    KMP_PRINTF(10, "__kmpc_dispatch_next_4 : [l %4d u %4d s %4d]\n", *p_lb,
+               *p_ub, *p_st);
+    return 1;
+}
 
 /*!
 @param loc Source code location
@@ -459,56 +533,23 @@ otherwise
 Get the next dynamically allocated chunk of work for this thread.
 If there is no more work, then the lb,ub and stride need not be modified.
 */
-// int __kmpc_dispatch_next_4(ident_t *loc, kmp_int32 gtid, kmp_int32 *p_last,
-//                            kmp_int32 *p_lb, kmp_int32 *p_ub, kmp_int32 *p_st)
-//                            {
-//     (void)loc;
-//     (void)gtid;
-
-//     omp_team_t *team = omp_get_team(omp_getData());
-
-//     // The stride is actually always 1
-//     *p_st = 1;
-
-//     // int result = dynLoopIter(team, (int*) p_lb, (int*) p_ub, (int*)
-//     p_last); eu_mutex_lock();
-
-//     // have already iterated over all the iterations(no more work), return 0
-//     if (team->loop_start > team->loop_end) {
-//         team->loop_is_setup = 0;
-//         KMP_PRINTF(
-//             10, "__kmpc_dispatch_next_4 start > end: team->loop_is_setup
-//             %d\n", team->loop_is_setup);
-//         eu_mutex_release();
-//         return 0;
-//     }
-
-//     *p_lb = team->loop_start;
-//     *p_ub = *p_lb + team->loop_chunk - 1;
-//     if (*p_ub >= team->loop_end) {
-//         *p_ub = team->loop_end;
-//         *p_last = 1;
-//     }
-
-//     team->loop_start += team->loop_chunk;
-//     KMP_PRINTF(10,
-//                "__kmpc_dispatch_next_4 : last: %d [l %4d u %4d s %4d] "
-//                "team->loop_start %d\n",
-//                *p_last, *p_lb, *p_ub, *p_st, team->loop_start);
-//     eu_mutex_release();
-//     return 1;
-// }
+int __kmpc_dispatch_next_4(ident_t *loc, kmp_int32 gtid, kmp_int32 *p_last,
+                           kmp_int32 *p_lb, kmp_int32 *p_ub, kmp_int32 *p_st) {
+    (void)loc;
+    (void)gtid;
+    return __kmp_dispatch_next(p_last, (kmp_uint32 *)p_lb, (kmp_uint32 *)p_ub,
+                               p_st);
+}
 
 /*!
 See @ref __kmpc_dispatch_next_4
 */
-// int __kmpc_dispatch_next_4u(ident_t *loc, kmp_int32 gtid, kmp_int32 *p_last,
-//                             kmp_uint32 *p_lb, kmp_uint32 *p_ub,
-//                             kmp_int32 *p_st) {
-//     kmp_int32 p_lbi = *p_lb;
-//     kmp_int32 p_ubi = *p_ub;
-//     int ret = __kmpc_dispatch_next_4(loc, gtid, p_last, &p_lbi, &p_ubi,
-//     p_st); *p_lb = p_lbi; *p_ub = p_ubi; return ret;
-// }
+int __kmpc_dispatch_next_4u(ident_t *loc, kmp_int32 gtid, kmp_int32 *p_last,
+                            kmp_uint32 *p_lb, kmp_uint32 *p_ub,
+                            kmp_int32 *p_st) {
+    (void)loc;
+    (void)gtid;
+    return __kmp_dispatch_next(p_last, p_lb, p_ub, p_st);
+}
 
 #endif  // #ifndef OMPSTATIC_NUMTHREADS
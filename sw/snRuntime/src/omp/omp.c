@@ -58,7 +58,8 @@ void omp_init(void) {
 
         omp_p->plainTeam.nbThreads = nbCores;
         omp_p->plainTeam.loop_epoch = 0;
-        omp_p->plainTeam.loop_is_setup = 0;
+        omp_p->plainTeam.loop_claimed = 0;
+        omp_p->plainTeam.loop_done = 0;
 
         for (int i = 0; i < sizeof(omp_p->plainTeam.core_epoch) /
                                 sizeof(omp_p->plainTeam.core_epoch[0]);
@@ -75,13 +75,18 @@
 typedef struct {
     char nbThreads;
 #ifndef OMPSTATIC_NUMTHREADS
-    int loop_epoch;
+    // Dynamically scheduled loop, set up by the first thread to reach it
+    volatile uint32_t loop_epoch;    // loops set up so far
+    volatile uint32_t loop_claimed;  // loops whose setup has been claimed
     int loop_start;
-    int loop_end;
     int loop_incr;
-    int loop_chunk;
-    int loop_is_setup;
-    int core_epoch[16];  // for dynamic scheduling
+    uint32_t loop_count;  // iterations
+    uint32_t loop_chunk;
+    uint32_t loop_guided;
+    uint32_t loop_threads;
+    volatile uint32_t loop_next;  // next iteration to hand out
+    volatile uint32_t loop_done;  // threads out of iterations
+    uint32_t core_epoch[16];      // loops each thread has entered
 #endif
 } omp_team_t;
 
@@ -0,0 +1,22 @@
+// Copyright 2024 KU Leuven.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Reserved in L3 by the linker script, and not initialized at startup
+snrt_prof_buffer_t snrt_prof_buffer __attribute__((section(".prof")));
+
+__thread snrt_prof_record_t *snrt_prof_stack[SNRT_PROF_MAX_DEPTH];
+__thread uint32_t snrt_prof_depth;
+__thread uint32_t snrt_prof_group;
+__thread uint32_t snrt_prof_num_counters;
+
+extern uint32_t snrt_prof_num_groups();
+
+extern void snrt_prof_select_group(uint32_t group);
+
+extern void snrt_prof_init(const snrt_prof_event_t *events,
+                           uint32_t num_events);
+
+extern void snrt_prof_begin(const char *name);
+
+extern void snrt_prof_end();
@@ -0,0 +1,133 @@
+// Copyright 2024 KU Leuven.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Open regions of the hart, innermost last. Null if a region was not recorded.
+extern __thread snrt_prof_record_t *snrt_prof_stack[SNRT_PROF_MAX_DEPTH];
+extern __thread uint32_t snrt_prof_depth;
+// Event group counted by the cluster, and its number of events
+extern __thread uint32_t snrt_prof_group;
+extern __thread uint32_t snrt_prof_num_counters;
+
+/**
+ * @brief Number of event groups, i.e. of runs of the profiled code needed to
+ * count all events
+ */
+inline uint32_t snrt_prof_num_groups() {
+    uint32_t num_events = snrt_prof_buffer.num_events;
+    return num_events ? (num_events + SNRT_PERF_N_CNT - 1) / SNRT_PERF_N_CNT
+                      : 1;
+}
+
+/**
+ * @brief Count the events of group `group` in the regions that follow
+ * @details The counters are shared by the cores of a cluster, so all of them
+ * must call this function, and none of them may be inside a region.
+ */
+inline void snrt_prof_select_group(uint32_t group) {
+    uint32_t first = group * SNRT_PERF_N_CNT;
+    uint32_t num = 0;
+    if (snrt_prof_buffer.num_events > first)
+        num = snrt_prof_buffer.num_events - first;
+    if (num > SNRT_PERF_N_CNT) num = SNRT_PERF_N_CNT;
+
+    snrt_cluster_hw_barrier();
+    if (snrt_cluster_core_idx() == 0) {
+        for (uint32_t i = 0; i < SNRT_PERF_N_CNT; i++) {
+            snrt_reset_perf_counter(i);
+            if (i < num) {
+                snrt_prof_event_t event = snrt_prof_buffer.event[first + i];
+                snrt_start_perf_counter(i, event.type, event.hart);
+            }
+        }
+    }
+    snrt_prof_group = group;
+    snrt_prof_num_counters = num;
+    snrt_cluster_hw_barrier();
+}
+
+/**
+ * @brief Set up the profiler to count `events`, starting with the first
+ * group
+ * @details Must be called by all cores of all clusters. Events beyond
+ * `SNRT_PERF_N_CNT` are counted in later groups, selected with
+ * `snrt_prof_select_group` between repeated runs of the profiled code.
+ */
+inline void snrt_prof_init(const snrt_prof_event_t *events,
+                           uint32_t num_events) {
+    if (num_events > SNRT_PROF_MAX_EVENTS) num_events = SNRT_PROF_MAX_EVENTS;
+
+    if (snrt_global_core_idx() == 0) {
+        snrt_prof_buffer.max_events = SNRT_PROF_MAX_EVENTS;
+        snrt_prof_buffer.num_events = num_events;
+        snrt_prof_buffer.capacity = SNRT_PROF_BUFFER_BYTES;
+        snrt_prof_buffer.used = 0;
+        snrt_prof_buffer.dropped = 0;
+        for (uint32_t i = 0; i < num_events; i++)
+            snrt_prof_buffer.event[i] = events[i];
+        snrt_prof_buffer.magic = SNRT_PROF_MAGIC;
+    }
+    snrt_prof_depth = 0;
+    snrt_global_barrier();
+    snrt_prof_select_group(0);
+}
+
+/**
+ * @brief Open the region `name` on this hart
+ * @details Appends a record to the profiler buffer and snapshots the
+ * counters of the current group and `mcycle`. `name` must not be empty, and
+ * only its first `SNRT_PROF_NAME_LEN` characters are kept. Regions nest up to
+ * `SNRT_PROF_MAX_DEPTH` deep. If the buffer is full, the region is counted
+ * as dropped.
+ */
+inline void snrt_prof_begin(const char *name) {
+    uint32_t depth = snrt_prof_depth++;
+    if (depth >= SNRT_PROF_MAX_DEPTH) return;
+
+    uint32_t num = snrt_prof_num_counters;
+    uint32_t size = sizeof(snrt_prof_record_t) + num * sizeof(uint32_t);
+    uint32_t offset =
+        __atomic_fetch_add(&snrt_prof_buffer.used, size, __ATOMIC_RELAXED);
+    snrt_prof_record_t *record = 0;
+
+    if (offset + size <= SNRT_PROF_BUFFER_BYTES) {
+        record = (snrt_prof_record_t *)((uint8_t *)snrt_prof_buffer.data +
+                                        offset);
+        uint32_t i = 0;
+        for (; i < SNRT_PROF_NAME_LEN && name[i]; i++)
+            record->name[i] = name[i];
+        for (; i < SNRT_PROF_NAME_LEN; i++) record->name[i] = 0;
+        record->hart = snrt_hartid();
+        record->group = snrt_prof_group;
+        record->closed = 0;
+        for (i = 0; i < num; i++) record->counter[i] = snrt_get_perf_counter(i);
+        record->cycles = snrt_mcycle();
+    } else {
+        // Only the first record that does not fit starts in the buffer. An
+        // empty name marks the end of the records there.
+        if (offset < SNRT_PROF_BUFFER_BYTES)
+            snrt_prof_buffer.data[offset / sizeof(uint32_t)] = 0;
+        __atomic_add_fetch(&snrt_prof_buffer.dropped, 1, __ATOMIC_RELAXED);
+    }
+    snrt_prof_stack[depth] = record;
+}
+
+/**
+ * @brief Close the innermost open region of this hart
+ */
+inline void snrt_prof_end() {
+    uint32_t cycles = snrt_mcycle();
+    uint32_t counter[SNRT_PERF_N_CNT];
+    uint32_t num = snrt_prof_num_counters;
+    for (uint32_t i = 0; i < num; i++) counter[i] = snrt_get_perf_counter(i);
+
+    uint32_t depth = --snrt_prof_depth;
+    if (depth >= SNRT_PROF_MAX_DEPTH) return;
+    snrt_prof_record_t *record = snrt_prof_stack[depth];
+    if (!record) return;
+
+    for (uint32_t i = 0; i < num; i++)
+        record->counter[i] = counter[i] - record->counter[i];
+    record->cycles = cycles - record->cycles;
+    record->closed = 1;
+}
@@ -0,0 +1,11 @@
+// Copyright 2024 KU Leuven.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+extern void snrt_reduce_words(void *dst, const void *a, const void *b,
+                              uint32_t words, snrt_dtype_t type,
+                              snrt_reduce_op_t op);
+
+extern void snrt_reduce_tail(void *dst, const void *a, const void *b,
+                             size_t bytes, snrt_dtype_t type,
+                             snrt_reduce_op_t op);
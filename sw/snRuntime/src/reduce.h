@@ -0,0 +1,98 @@
+// Copyright 2024 KU Leuven.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Floating-point kernels of `snrt_cluster_reduce`, on the SSRs, the FREP
+// sequencer and the packed SIMD instructions. Runtimes built for a generic
+// RISC-V target include `reduce_generic.h` instead.
+
+// Expands `X(insn)` with the instruction which reduces two registers of
+// packed elements of type `type` with `op`. For fp32 and fp16, the packed
+// SIMD instructions reduce all elements of the 64-bit register at once.
+#define SNRT_REDUCE_DISPATCH(type, op, X)          \
+    switch ((type)*3 + (op)) {                     \
+        case SNRT_FP64 * 3 + SNRT_REDUCE_SUM:      \
+            X("fadd.d");                           \
+            break;                                 \
+        case SNRT_FP64 * 3 + SNRT_REDUCE_MAX:      \
+            X("fmax.d");                           \
+            break;                                 \
+        case SNRT_FP64 * 3 + SNRT_REDUCE_MIN:      \
+            X("fmin.d");                           \
+            break;                                 \
+        case SNRT_FP32 * 3 + SNRT_REDUCE_SUM:      \
+            X("vfadd.s");                          \
+            break;                                 \
+        case SNRT_FP32 * 3 + SNRT_REDUCE_MAX:      \
+            X("vfmax.s");                          \
+            break;                                 \
+        case SNRT_FP32 * 3 + SNRT_REDUCE_MIN:      \
+            X("vfmin.s");                          \
+            break;                                 \
+        case SNRT_FP16 * 3 + SNRT_REDUCE_SUM:      \
+            X("vfadd.h");                          \
+            break;                                 \
+        case SNRT_FP16 * 3 + SNRT_REDUCE_MAX:      \
+            X("vfmax.h");                          \
+            break;                                 \
+        case SNRT_FP16 * 3 + SNRT_REDUCE_MIN:      \
+            X("vfmin.h");                          \
+            break;                                 \
+    }
+
+/**
+ * @brief Reduce `words` 64-bit words of floating-point elements
+ * @details Streams `a` and `b` in and `dst` out through the SSRs, and issues
+ * the reduction from the FREP sequencer. All buffers must be 8-byte aligned.
+ */
+inline void snrt_reduce_words(void *dst, const void *a, const void *b,
+                              uint32_t words, snrt_dtype_t type,
+                              snrt_reduce_op_t op) {
+    if (!words) return;
+
+    snrt_ssr_loop_1d(SNRT_SSR_DM0, words, sizeof(double));
+    snrt_ssr_loop_1d(SNRT_SSR_DM1, words, sizeof(double));
+    snrt_ssr_loop_1d(SNRT_SSR_DM2, words, sizeof(double));
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, (void *)a);
+    snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_1D, (void *)b);
+    snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_1D, dst);
+    snrt_ssr_enable();
+
+#define SNRT_REDUCE_FREP(insn)                                   \
+    asm volatile("frep.o %[n_frep], 1, 0, 0 \n" insn             \
+                 " ft2, ft0, ft1\n" ::[n_frep] "r"(words - 1)    \
+                 : "ft0", "ft1", "ft2", "memory")
+    SNRT_REDUCE_DISPATCH(type, op, SNRT_REDUCE_FREP)
+#undef SNRT_REDUCE_FREP
+
+    snrt_ssr_disable();
+    snrt_fpu_fence();
+}
+
+/**
+ * @brief Reduce the floating-point elements of a partial word of `bytes`
+ * bytes, through zero-padded copies
+ */
+inline void snrt_reduce_tail(void *dst, const void *a, const void *b,
+                             size_t bytes, snrt_dtype_t type,
+                             snrt_reduce_op_t op) {
+    uint64_t x = 0, y = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        ((uint8_t *)&x)[i] = ((const uint8_t *)a)[i];
+        ((uint8_t *)&y)[i] = ((const uint8_t *)b)[i];
+    }
+
+#define SNRT_REDUCE_WORD(insn)                                           \
+    asm volatile("fld ft3, 0(%[x])\n"                                    \
+                 "fld ft4, 0(%[y])\n" insn                               \
+                 " ft3, ft3, ft4\n"                                      \
+                 "fsd ft3, 0(%[x])\n" ::[x] "r"(&x),                     \
+                 [y] "r"(&y)                                             \
+                 : "ft3", "ft4", "memory")
+    SNRT_REDUCE_DISPATCH(type, op, SNRT_REDUCE_WORD)
+#undef SNRT_REDUCE_WORD
+
+    snrt_fpu_fence();
+    for (size_t i = 0; i < bytes; i++)
+        ((uint8_t *)dst)[i] = ((uint8_t *)&x)[i];
+}
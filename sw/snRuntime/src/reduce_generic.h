@@ -0,0 +1,73 @@
+// Copyright 2024 KU Leuven.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Floating-point kernels of `snrt_cluster_reduce` for runtimes built for a
+// generic RISC-V target, which lacks the SSRs, FREP and the packed SIMD
+// instructions. Every element is reduced by a scalar instruction.
+
+// Expands `X(load, store, insn)` with the instructions which load, store and
+// reduce one element of type `type` with `op`.
+#define SNRT_REDUCE_DISPATCH(type, op, X)              \
+    switch ((type)*3 + (op)) {                         \
+        case SNRT_FP64 * 3 + SNRT_REDUCE_SUM:          \
+            X("fld", "fsd", "fadd.d");                 \
+            break;                                     \
+        case SNRT_FP64 * 3 + SNRT_REDUCE_MAX:          \
+            X("fld", "fsd", "fmax.d");                 \
+            break;                                     \
+        case SNRT_FP64 * 3 + SNRT_REDUCE_MIN:          \
+            X("fld", "fsd", "fmin.d");                 \
+            break;                                     \
+        case SNRT_FP32 * 3 + SNRT_REDUCE_SUM:          \
+            X("flw", "fsw", "fadd.s");                 \
+            break;                                     \
+        case SNRT_FP32 * 3 + SNRT_REDUCE_MAX:          \
+            X("flw", "fsw", "fmax.s");                 \
+            break;                                     \
+        case SNRT_FP32 * 3 + SNRT_REDUCE_MIN:          \
+            X("flw", "fsw", "fmin.s");                 \
+            break;                                     \
+        case SNRT_FP16 * 3 + SNRT_REDUCE_SUM:          \
+            X("flh", "fsh", "fadd.h");                 \
+            break;                                     \
+        case SNRT_FP16 * 3 + SNRT_REDUCE_MAX:          \
+            X("flh", "fsh", "fmax.h");                 \
+            break;                                     \
+        case SNRT_FP16 * 3 + SNRT_REDUCE_MIN:          \
+            X("flh", "fsh", "fmin.h");                 \
+            break;                                     \
+    }
+
+/**
+ * @brief Reduce the floating-point elements of a partial word of `bytes`
+ * bytes
+ * @details Reduces one element at a time, so `bytes` may also span whole
+ * words.
+ */
+inline void snrt_reduce_tail(void *dst, const void *a, const void *b,
+                             size_t bytes, snrt_dtype_t type,
+                             snrt_reduce_op_t op) {
+    size_t size = snrt_dtype_size(type);
+
+    for (size_t i = 0; i < bytes; i += size) {
+        const uint8_t *x = (const uint8_t *)a + i;
+        const uint8_t *y = (const uint8_t *)b + i;
+        uint8_t *z = (uint8_t *)dst + i;
+
+#define SNRT_REDUCE_ELEMENT(load, store, insn)                            \
+    asm volatile(load " ft0, 0(%[x])\n" load " ft1, 0(%[y])\n" insn       \
+                 " ft0, ft0, ft1\n" store " ft0, 0(%[z])\n" ::[x] "r"(x), \
+                 [y] "r"(y), [z] "r"(z)                                   \
+                 : "ft0", "ft1", "memory")
+        SNRT_REDUCE_DISPATCH(type, op, SNRT_REDUCE_ELEMENT)
+#undef SNRT_REDUCE_ELEMENT
+    }
+}
+
+/// Reduce `words` 64-bit words of floating-point elements
+inline void snrt_reduce_words(void *dst, const void *a, const void *b,
+                              uint32_t words, snrt_dtype_t type,
+                              snrt_reduce_op_t op) {
+    snrt_reduce_tail(dst, a, b, words * sizeof(uint64_t), type, op);
+}
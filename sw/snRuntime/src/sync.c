@@ -22,13 +22,81 @@ extern void snrt_mutex_ttas_acquire(volatile uint32_t *pmtx);
 
 extern void snrt_mutex_release(volatile uint32_t *pmtx);
 
+extern void snrt_mutex_ticket_acquire(volatile snrt_ticket_mutex_t *mtx);
+
+extern void snrt_mutex_ticket_release(volatile snrt_ticket_mutex_t *mtx);
+
+extern void snrt_mutex_mcs_acquire(volatile snrt_mcs_mutex_t *mtx);
+
+extern void snrt_mutex_mcs_release(volatile snrt_mcs_mutex_t *mtx);
+
 extern void snrt_cluster_hw_barrier();
 
+extern void snrt_global_flat_barrier();
+
+extern snrt_tree_barrier_t *snrt_global_barrier_node(uint32_t cluster);
+
+extern void snrt_global_tree_barrier();
+
 extern void snrt_global_barrier();
 
 extern void snrt_partial_barrier(snrt_barrier_t *barr, uint32_t n);
 
+extern size_t snrt_dtype_size(snrt_dtype_t type);
+
+extern void *snrt_remote_l1_ptr(const void *ptr, uint32_t cluster);
+
+extern void *snrt_cluster_ptr(const void *ptr, uint32_t cluster);
+
+extern volatile uint32_t *snrt_collective_progress(uint32_t cluster);
+
+extern void snrt_reduce_int32(int32_t *dst, const int32_t *a,
+                              const int32_t *b, size_t len,
+                              snrt_reduce_op_t op);
+
+extern void snrt_cluster_reduce(void *dst, const void *a, const void *b,
+                                size_t len, snrt_dtype_t type,
+                                snrt_reduce_op_t op);
+
+extern uint32_t snrt_reduce_num_chunks(size_t bytes);
+
+extern size_t snrt_reduce_chunk_size(size_t bytes, uint32_t k);
+
+extern snrt_dma_txid_t snrt_reduce_fetch(void *buf, const void *remote,
+                                         uint32_t cluster, size_t bytes,
+                                         uint32_t k, uint32_t ring,
+                                         uint32_t base);
+
+extern void snrt_reduce_pull(void *dst, const void *a, const void *remote,
+                             uint32_t cluster, size_t len, snrt_dtype_t type,
+                             snrt_reduce_op_t op, uint32_t ring);
+
+extern void snrt_global_tree_reduction(void *dst, const void *src, size_t len,
+                                       snrt_dtype_t type,
+                                       snrt_reduce_op_t op);
+
+extern void snrt_global_ring_reduction(void *dst, const void *src, size_t len,
+                                       snrt_dtype_t type,
+                                       snrt_reduce_op_t op);
+
+extern snrt_reduce_alg_t snrt_global_reduction_algorithm(size_t bytes);
+
+extern void snrt_global_reduction(void *dst, const void *src, size_t len,
+                                  snrt_dtype_t type, snrt_reduce_op_t op,
+                                  snrt_reduce_alg_t alg);
+
 extern void snrt_global_reduction_dma(double *dst_buffer, double *src_buffer,
                                       size_t len);
 
 extern uint32_t snrt_global_all_to_all_reduction(uint32_t value);
+
+extern void snrt_global_broadcast(void *dst, const void *src, size_t size,
+                                  uint32_t root);
+
+extern void snrt_global_scatter(void *dst, const void *src, size_t size,
+                                uint32_t root);
+
+extern void snrt_global_gather(void *dst, const void *src, size_t size,
+                               uint32_t root);
+
+extern void snrt_global_all_gather(void *dst, const void *src, size_t size);
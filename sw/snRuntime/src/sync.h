@@ -57,6 +57,73 @@ inline void snrt_mutex_release(volatile uint32_t *pmtx) {
                  : "+r"(pmtx));
 }
 
+/**
+ * @brief Lock a ticket mutex, blocking
+ * @details Cores enter in the order they arrived. A single atomic increment
+ * takes the ticket, then each waiter spins on the slot of its ticket only,
+ * so that waiters do not contend for one TCDM bank. Declare the mutex with
+ * `static snrt_ticket_mutex_t mtx = {0};` or zero it.
+ */
+inline void snrt_mutex_ticket_acquire(volatile snrt_ticket_mutex_t *mtx) {
+    uint32_t ticket = __atomic_fetch_add(&mtx->next, 1, __ATOMIC_RELAXED);
+    volatile uint32_t *slot =
+        &mtx->slot[ticket % SNRT_TICKET_MUTEX_SLOTS].ticket;
+    while (__atomic_load_n(slot, __ATOMIC_ACQUIRE) != ticket)
+        ;
+    mtx->owner = ticket;
+}
+
+/**
+ * @brief Release a ticket mutex to the next ticket
+ */
+inline void snrt_mutex_ticket_release(volatile snrt_ticket_mutex_t *mtx) {
+    uint32_t ticket = mtx->owner + 1;
+    __atomic_store_n(&mtx->slot[ticket % SNRT_TICKET_MUTEX_SLOTS].ticket,
+                     ticket, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Lock an MCS mutex, blocking
+ * @details The core appends its node to the queue with an atomic swap of the
+ * tail and, if the mutex is held, spins on its own node until its
+ * predecessor releases it. Cores enter in the order they arrived. The nodes
+ * are part of the mutex, so it is only shared by the cores of a cluster.
+ * Declare the mutex with `static snrt_mcs_mutex_t mtx = {0};` or zero it.
+ */
+inline void snrt_mutex_mcs_acquire(volatile snrt_mcs_mutex_t *mtx) {
+    snrt_mcs_node_t *node =
+        (snrt_mcs_node_t *)&mtx->node[snrt_cluster_core_idx()];
+    snrt_mcs_node_t *prev;
+
+    node->next = 0;
+    node->locked = 1;
+    prev = __atomic_exchange_n(&mtx->tail, node, __ATOMIC_ACQ_REL);
+    if (prev) {
+        prev->next = node;
+        while (__atomic_load_n(&node->locked, __ATOMIC_ACQUIRE))
+            ;
+    }
+}
+
+/**
+ * @brief Release an MCS mutex to the next core in the queue
+ */
+inline void snrt_mutex_mcs_release(volatile snrt_mcs_mutex_t *mtx) {
+    snrt_mcs_node_t *node =
+        (snrt_mcs_node_t *)&mtx->node[snrt_cluster_core_idx()];
+    snrt_mcs_node_t *tail = node;
+
+    if (!node->next) {
+        // No successor queued yet: unlock, unless one is just arriving
+        if (__atomic_compare_exchange_n(&mtx->tail, &tail, 0, 0,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            return;
+        while (!node->next)
+            ;
+    }
+    __atomic_store_n(&node->next->locked, 0, __ATOMIC_RELEASE);
+}
+
 //================================================================================
 // Barrier functions
 //================================================================================
@@ -66,8 +133,9 @@ inline void snrt_cluster_hw_barrier() {
     asm volatile("csrr x0, 0x7C2" ::: "memory");
 }
 
-/// Synchronize clusters globally with a global software barrier
-inline void snrt_global_barrier() {
+/// Synchronize clusters globally with a flat software barrier, where all DM
+/// cores count on and poll a single location in global memory
+inline void snrt_global_flat_barrier() {
     snrt_cluster_hw_barrier();
 
     // Synchronize all DM cores in software
@@ -90,6 +158,80 @@ inline void snrt_global_barrier() {
     snrt_cluster_hw_barrier();
 }
 
+/// Node of the global barrier tree in the TCDM of cluster `cluster`
+inline snrt_tree_barrier_t *snrt_global_barrier_node(uint32_t cluster) {
+    uint32_t node = (uint32_t)&cls()->global_barrier;
+    return (snrt_tree_barrier_t *)(node + (cluster - snrt_cluster_idx()) *
+                                              SNRT_CLUSTER_OFFSET);
+}
+
+/**
+ * @brief Synchronize clusters globally with a tree barrier
+ * @details Clusters are grouped by SNRT_BARRIER_ARITY, and the first cluster
+ * of every group leads it at the next level. The DM core of a leader waits
+ * for its children to flag their arrival in its TCDM, then flags its own
+ * arrival to its parent and waits for the parent to release it. The
+ * releases propagate back down the tree. Every DM core spins on its own
+ * TCDM only, and the sense of the flags flips with every barrier so that
+ * they never need to be reset.
+ */
+inline void snrt_global_tree_barrier() {
+    snrt_cluster_hw_barrier();
+
+    if (snrt_is_dm_core()) {
+        uint32_t n = snrt_cluster_num(), c = snrt_cluster_idx();
+        snrt_tree_barrier_t *node = &cls()->global_barrier;
+        uint32_t sense = !node->sense;
+        uint32_t level = 0, span = 1;
+        node->sense = sense;
+
+        // Make this cluster's writes visible before arriving
+        asm volatile("fence" ::: "memory");
+
+        // Gather the children of every level this cluster leads, then
+        // report to the parent and wait for the release
+        for (; span < n; span *= SNRT_BARRIER_ARITY, level++) {
+            uint32_t offset = c % (span * SNRT_BARRIER_ARITY);
+            if (offset) {
+                snrt_tree_barrier_t *parent =
+                    snrt_global_barrier_node(c - offset);
+                parent->arrive[level][offset / span] = sense;
+                while (node->release != sense)
+                    ;
+                break;
+            }
+            for (uint32_t i = 1; i < SNRT_BARRIER_ARITY && c + i * span < n;
+                 i++)
+                while (node->arrive[level][i] != sense)
+                    ;
+        }
+
+        // Release the children, top level first
+        while (level--) {
+            span /= SNRT_BARRIER_ARITY;
+            for (uint32_t i = 1; i < SNRT_BARRIER_ARITY && c + i * span < n;
+                 i++)
+                snrt_global_barrier_node(c + i * span)->release = sense;
+        }
+    }
+
+    snrt_cluster_hw_barrier();
+}
+
+/// Synchronize clusters globally with a global software barrier. Uses the
+/// tree barrier, unless SNRT_GLOBAL_BARRIER_FLAT is defined or there are too
+/// many clusters for the tree.
+inline void snrt_global_barrier() {
+#ifdef SNRT_GLOBAL_BARRIER_FLAT
+    snrt_global_flat_barrier();
+#else
+    if (snrt_cluster_num() > SNRT_BARRIER_MAX_CLUSTERS)
+        snrt_global_flat_barrier();
+    else
+        snrt_global_tree_barrier();
+#endif
+}
+
 inline uint32_t snrt_global_all_to_all_reduction(uint32_t value) {
     __atomic_add_fetch(&_reduction_result, value, __ATOMIC_RELAXED);
     snrt_global_barrier();
@@ -122,59 +264,396 @@ inline void snrt_partial_barrier(snrt_barrier_t *barr, uint32_t n) {
 // Reduction functions
 //================================================================================
 
-// Assumes the dst and src buffers are at the same offset in the TCDM of every
-// cluster
-inline void snrt_global_reduction_dma(double *dst_buffer, double *src_buffer,
-                                      size_t len) {
-    // If we have a single cluster the reduction degenerates to a memcpy
-    if (snrt_cluster_num() == 1) {
-        if (!snrt_is_compute_core()) {
-            snrt_dma_start_1d(dst_buffer, src_buffer, len * sizeof(double));
-            snrt_dma_wait_all();
+/// Size in bytes of an element of type `type`
+inline size_t snrt_dtype_size(snrt_dtype_t type) {
+    switch (type) {
+        case SNRT_FP64:
+            return 8;
+        case SNRT_FP16:
+            return 2;
+        default:
+            return 4;
+    }
+}
+
+/// Address of `ptr` in the TCDM of cluster `cluster`
+inline void *snrt_remote_l1_ptr(const void *ptr, uint32_t cluster) {
+    return (void *)((uint32_t)ptr +
+                    (cluster - snrt_cluster_idx()) * SNRT_CLUSTER_OFFSET);
+}
+
+/// Address of `ptr` in the TCDM of cluster `cluster` if it points into the
+/// TCDM, `ptr` itself otherwise, e.g. in main memory
+inline void *snrt_cluster_ptr(const void *ptr, uint32_t cluster) {
+    uint32_t addr = (uint32_t)ptr;
+    if (addr >= snrt_l1_start_addr() && addr < snrt_l1_end_addr())
+        return snrt_remote_l1_ptr(ptr, cluster);
+    return (void *)ptr;
+}
+
+/// Progress counter of the collectives of cluster `cluster`
+inline volatile uint32_t *snrt_collective_progress(uint32_t cluster) {
+    return (volatile uint32_t *)snrt_remote_l1_ptr(
+        (void *)&cls()->collective.progress, cluster);
+}
+
+/// Reduce `len` int32 elements
+inline void snrt_reduce_int32(int32_t *dst, const int32_t *a,
+                              const int32_t *b, size_t len,
+                              snrt_reduce_op_t op) {
+    switch (op) {
+        case SNRT_REDUCE_SUM:
+            for (size_t i = 0; i < len; i++) dst[i] = a[i] + b[i];
+            break;
+        case SNRT_REDUCE_MAX:
+            for (size_t i = 0; i < len; i++)
+                dst[i] = a[i] > b[i] ? a[i] : b[i];
+            break;
+        case SNRT_REDUCE_MIN:
+            for (size_t i = 0; i < len; i++)
+                dst[i] = a[i] < b[i] ? a[i] : b[i];
+            break;
+    }
+}
+
+/**
+ * @brief Compute `dst = a op b` elementwise over `len` elements
+ * @details Must be called by all compute cores of the cluster, which split
+ * the elements (the 64-bit words of floating-point elements) as evenly as
+ * possible. The last core also reduces a trailing partial word. The buffers
+ * must be 8-byte aligned, and `dst` may be `a` or `b`.
+ */
+inline void snrt_cluster_reduce(void *dst, const void *a, const void *b,
+                                size_t len, snrt_dtype_t type,
+                                snrt_reduce_op_t op) {
+    uint32_t n = snrt_cluster_compute_core_num();
+    uint32_t i = snrt_cluster_core_idx();
+    size_t bytes = len * snrt_dtype_size(type);
+    size_t unit = type == SNRT_INT32 ? sizeof(int32_t) : sizeof(uint64_t);
+    size_t units = bytes / unit;
+    size_t count = units / n + (i < units % n);
+    size_t offset = (i * (units / n) + (i < units % n ? i : units % n)) * unit;
+
+    if (type == SNRT_INT32) {
+        snrt_reduce_int32((int32_t *)((uint8_t *)dst + offset),
+                          (const int32_t *)((const uint8_t *)a + offset),
+                          (const int32_t *)((const uint8_t *)b + offset),
+                          count, op);
+        return;
+    }
+    snrt_reduce_words((uint8_t *)dst + offset, (const uint8_t *)a + offset,
+                      (const uint8_t *)b + offset, count, type, op);
+    if (i == n - 1 && bytes % unit) {
+        offset = units * unit;
+        snrt_reduce_tail((uint8_t *)dst + offset, (const uint8_t *)a + offset,
+                         (const uint8_t *)b + offset, bytes % unit, type, op);
+    }
+}
+
+/// Number of chunks a reduction of `bytes` bytes works on
+inline uint32_t snrt_reduce_num_chunks(size_t bytes) {
+    return (bytes + SNRT_REDUCE_CHUNK_BYTES - 1) / SNRT_REDUCE_CHUNK_BYTES;
+}
+
+/// Size of chunk `k` of a reduction of `bytes` bytes
+inline size_t snrt_reduce_chunk_size(size_t bytes, uint32_t k) {
+    size_t left = bytes - k * SNRT_REDUCE_CHUNK_BYTES;
+    return left < SNRT_REDUCE_CHUNK_BYTES ? left : SNRT_REDUCE_CHUNK_BYTES;
+}
+
+/**
+ * @brief Pull chunk `k` of the buffer `remote` of cluster `cluster`
+ * @details In a ring reduction, first waits for the remote cluster to count
+ * the chunk as reduced.
+ */
+inline snrt_dma_txid_t snrt_reduce_fetch(void *buf, const void *remote,
+                                         uint32_t cluster, size_t bytes,
+                                         uint32_t k, uint32_t ring,
+                                         uint32_t base) {
+    if (ring) {
+        volatile uint32_t *progress = snrt_collective_progress(cluster);
+        while ((int32_t)(*progress - (base + k + 1)) < 0)
+            ;
+    }
+    return snrt_dma_start_1d(
+        (uint8_t *)buf + (k % 2) * SNRT_REDUCE_CHUNK_BYTES,
+        (const uint8_t *)remote + k * SNRT_REDUCE_CHUNK_BYTES,
+        snrt_reduce_chunk_size(bytes, k));
+}
+
+/**
+ * @brief Compute `dst = a op remote`, with `remote` in cluster `cluster`
+ * @details Must be called by all cores of the cluster. The DM core pulls
+ * `remote` chunk by chunk into two L1 buffers. It transfers chunk `k + 1`
+ * while the compute cores reduce chunk `k` with `snrt_cluster_reduce`, and
+ * both sides meet at one cluster barrier per chunk. In a ring reduction, the
+ * DM core also counts every chunk this cluster reduced in its progress
+ * counter.
+ */
+inline void snrt_reduce_pull(void *dst, const void *a, const void *remote,
+                             uint32_t cluster, size_t len, snrt_dtype_t type,
+                             snrt_reduce_op_t op, uint32_t ring) {
+    snrt_collective_state_t *state = &cls()->collective;
+    size_t bytes = len * snrt_dtype_size(type);
+    uint32_t n = snrt_reduce_num_chunks(bytes);
+
+    if (snrt_is_dm_core()) {
+        uint32_t base = state->progress;
+        snrt_l1_arena_t arena = snrt_l1_arena_push();
+        void *buf = snrt_l1alloc_aligned(2 * SNRT_REDUCE_CHUNK_BYTES,
+                                         SNRT_DMA_BEAT_BYTES);
+        snrt_dma_txid_t txid = -1;
+        state->buf = buf;
+
+        if (n)
+            txid =
+                snrt_reduce_fetch(buf, remote, cluster, bytes, 0, ring, base);
+        for (uint32_t k = 0; k <= n; k++) {
+            if (k < n) snrt_dma_wait(txid);
+            snrt_cluster_hw_barrier();
+            // Chunk k - 1 is reduced and its buffer free
+            if (ring && k) state->progress = base + k;
+            if (k + 1 < n)
+                txid = snrt_reduce_fetch(buf, remote, cluster, bytes, k + 1,
+                                         ring, base);
         }
-        snrt_cluster_hw_barrier();
+        snrt_l1_arena_pop(arena);
     } else {
-        // Iterate levels in the binary reduction tree
-        int num_levels = ceil(log2(snrt_cluster_num()));
-        for (unsigned int level = 0; level < num_levels; level++) {
-            // Determine whether the current cluster is an active cluster.
-            // An active cluster is a cluster that participates in the current
-            // level of the reduction tree. Every second cluster among the
-            // active ones is a sender.
-            uint32_t is_active = (snrt_cluster_idx() % (1 << level)) == 0;
-            uint32_t is_sender = (snrt_cluster_idx() % (1 << (level + 1))) != 0;
-
-            // If the cluster is a sender, it sends the data in its source
-            // buffer to the respective receiver's destination buffer
-            if (is_active && is_sender) {
-                if (!snrt_is_compute_core()) {
-                    void *dst =
-                        (void *)dst_buffer - (1 << level) * SNRT_CLUSTER_OFFSET;
-                    snrt_dma_start_1d(dst, src_buffer, len * sizeof(double));
-                    snrt_dma_wait_all();
-                }
-            }
+        for (uint32_t k = 0; k <= n; k++) {
+            snrt_cluster_hw_barrier();
+            if (k == n) break;
+            size_t offset = k * SNRT_REDUCE_CHUNK_BYTES;
+            snrt_cluster_reduce(
+                (uint8_t *)dst + offset, (const uint8_t *)a + offset,
+                (uint8_t *)state->buf + (k % 2) * SNRT_REDUCE_CHUNK_BYTES,
+                snrt_reduce_chunk_size(bytes, k) / snrt_dtype_size(type), type,
+                op);
+        }
+    }
+}
+
+/**
+ * @brief Global reduction along a binary tree
+ * @details At level `l`, every cluster whose index is a multiple of
+ * `2^(l+1)` pulls the partial result of the cluster `2^l` after it. A
+ * cluster's partial result is its `src` until it reduced into its `dst`.
+ * The levels are separated by global barriers.
+ */
+inline void snrt_global_tree_reduction(void *dst, const void *src, size_t len,
+                                       snrt_dtype_t type,
+                                       snrt_reduce_op_t op) {
+    uint32_t c = snrt_cluster_idx(), n = snrt_cluster_num();
+
+    snrt_global_barrier();
+    for (uint32_t span = 1; span < n; span *= 2) {
+        uint32_t sender = c + span;
+        if (c % (2 * span) == 0 && sender < n) {
+            const void *partial = span > 1 && sender + 1 < n ? dst : src;
+            snrt_reduce_pull(dst, span == 1 ? src : dst,
+                             snrt_remote_l1_ptr(partial, sender), sender, len,
+                             type, op, 0);
+        }
+        snrt_global_barrier();
+    }
+}
+
+/**
+ * @brief Global reduction along a chain from the last cluster to cluster 0
+ * @details Every cluster reduces its `src` with the partial result of the
+ * next cluster into its `dst`, chunk by chunk, as soon as the next cluster
+ * counted the chunk as reduced. All clusters thus work at the same time on
+ * different chunks. The progress counters only ever grow, by the number of
+ * chunks in every ring reduction, so they need no reset.
+ */
+inline void snrt_global_ring_reduction(void *dst, const void *src, size_t len,
+                                       snrt_dtype_t type,
+                                       snrt_reduce_op_t op) {
+    uint32_t c = snrt_cluster_idx(), n = snrt_cluster_num();
+    uint32_t chunks = snrt_reduce_num_chunks(len * snrt_dtype_size(type));
+
+    // The compute cores may have just written `src`
+    snrt_cluster_hw_barrier();
+    if (c == n - 1) {
+        if (snrt_is_dm_core()) {
+            asm volatile("fence" ::: "memory");
+            cls()->collective.progress += chunks;
+        }
+    } else {
+        const void *partial = c + 1 == n - 1 ? src : dst;
+        snrt_reduce_pull(dst, src, snrt_remote_l1_ptr(partial, c + 1), c + 1,
+                         len, type, op, 1);
+    }
+    // The previous cluster may still read this cluster's partial result
+    snrt_global_barrier();
+}
+
+/**
+ * @brief Algorithm for a global reduction of `bytes` bytes
+ * @details The ring takes about `n - 1 + chunks` chunk steps on `n`
+ * clusters, the tree `log2(n) * chunks` steps and fewer global barriers.
+ */
+inline snrt_reduce_alg_t snrt_global_reduction_algorithm(size_t bytes) {
+    uint32_t n = snrt_cluster_num();
+    if (n > 2 && bytes >= n * SNRT_REDUCE_CHUNK_BYTES) return SNRT_REDUCE_RING;
+    return SNRT_REDUCE_TREE;
+}
+
+/**
+ * @brief Reduce `len` elements of `src` over all clusters into `dst`
+ * @details Must be called by all cores of all clusters. The result is written
+ * to `dst` of cluster 0, while `dst` of the other clusters serves as scratch
+ * space. `src` and `dst` must be 8-byte aligned and at the same offset in the
+ * TCDM of every cluster. `src` is left unchanged, unless it is `dst`.
+ *
+ * @param type element type
+ * @param op reduction operator
+ * @param alg algorithm, SNRT_REDUCE_AUTO to pick it by buffer size
+ */
+inline void snrt_global_reduction(void *dst, const void *src, size_t len,
+                                  snrt_dtype_t type, snrt_reduce_op_t op,
+                                  snrt_reduce_alg_t alg) {
+    size_t bytes = len * snrt_dtype_size(type);
+
+    // With a single cluster the reduction degenerates to a copy
+    if (snrt_cluster_num() == 1) {
+        snrt_cluster_hw_barrier();
+        if (snrt_is_dm_core() && dst != src)
+            snrt_dma_wait(snrt_dma_start_memcpy(dst, src, bytes));
+        snrt_cluster_hw_barrier();
+        return;
+    }
+
+    if (alg == SNRT_REDUCE_AUTO) alg = snrt_global_reduction_algorithm(bytes);
+    if (alg == SNRT_REDUCE_RING)
+        snrt_global_ring_reduction(dst, src, len, type, op);
+    else
+        snrt_global_tree_reduction(dst, src, len, type, op);
+}
+
+/// Sum `len` doubles of `src` over all clusters into `dst` of cluster 0.
+/// Assumes the buffers are at the same offset in the TCDM of every cluster.
+inline void snrt_global_reduction_dma(double *dst_buffer, double *src_buffer,
+                                      size_t len) {
+    snrt_global_reduction(dst_buffer, src_buffer, len, SNRT_FP64,
+                          SNRT_REDUCE_SUM, SNRT_REDUCE_AUTO);
+}
+
+//================================================================================
+// Data movement collectives
+//================================================================================
 
-            // Synchronize senders and receivers
-            snrt_global_barrier();
-
-            // Every cluster which is not a sender performs the reduction
-            if (is_active && !is_sender) {
-                // Computation is parallelized over the compute cores
-                if (snrt_is_compute_core()) {
-                    uint32_t items_per_core =
-                        len / snrt_cluster_compute_core_num();
-                    uint32_t core_offset =
-                        snrt_cluster_core_idx() * items_per_core;
-                    for (uint32_t i = 0; i < items_per_core; i++) {
-                        uint32_t abs_i = core_offset + i;
-                        dst_buffer[abs_i] += src_buffer[abs_i];
-                    }
+/**
+ * @brief Copy `size` bytes from `src` of cluster `root` to `dst` of all
+ * clusters
+ * @details Must be called by all cores of all clusters. `dst` must be at the
+ * same offset in the TCDM of every cluster. `src` may be in main memory, or
+ * in the TCDM of `root`, where it may be `dst`. The data fans out along a
+ * binomial tree: only the root reads `src`, and every other cluster pulls
+ * the data from `dst` of its parent. A cluster pulls every chunk of
+ * SNRT_BCAST_CHUNK_BYTES as soon as its parent counted it in its progress
+ * counter, so that all levels of the tree copy at the same time.
+ */
+inline void snrt_global_broadcast(void *dst, const void *src, size_t size,
+                                  uint32_t root) {
+    // The compute cores may have just written `src`
+    snrt_cluster_hw_barrier();
+
+    if (snrt_is_dm_core()) {
+        uint32_t n = snrt_cluster_num();
+        uint32_t rank = (snrt_cluster_idx() + n - root) % n;
+        uint32_t parent = (root + (rank & (rank - 1))) % n;
+        uint32_t chunks =
+            (size + SNRT_BCAST_CHUNK_BYTES - 1) / SNRT_BCAST_CHUNK_BYTES;
+        volatile uint32_t *progress = &cls()->collective.progress;
+        volatile uint32_t *ready = snrt_collective_progress(parent);
+        const uint8_t *from = rank ? snrt_remote_l1_ptr(dst, parent) : src;
+        uint32_t base = *progress;
+        snrt_dma_txid_t txid = -1;
+
+        if (from == dst) {
+            *progress = base + chunks;
+        } else {
+            for (uint32_t k = 0; k < chunks; k++) {
+                size_t offset = k * SNRT_BCAST_CHUNK_BYTES;
+                size_t left = size - offset;
+                snrt_dma_txid_t prev = txid;
+                if (rank)
+                    while ((int32_t)(*ready - (base + k + 1)) < 0)
+                        ;
+                txid = snrt_dma_start_1d(
+                    (uint8_t *)dst + offset, from + offset,
+                    left < SNRT_BCAST_CHUNK_BYTES ? left
+                                                  : SNRT_BCAST_CHUNK_BYTES);
+                // The previous chunk completed before this one
+                if (k) {
+                    snrt_dma_wait(prev);
+                    *progress = base + k;
                 }
             }
-
-            // Synchronize compute and DM cores for next tree level
-            snrt_cluster_hw_barrier();
+            snrt_dma_wait(txid);
+            *progress = base + chunks;
         }
     }
+
+    // The children may still read this cluster's `dst`
+    snrt_global_barrier();
+}
+
+/**
+ * @brief Copy block `i` of `size` bytes of `src` of cluster `root` to `dst`
+ * of cluster `i`, for all clusters
+ * @details Must be called by all cores of all clusters. `src` may be in main
+ * memory, or in the TCDM of `root`, and must be the same address, or at the
+ * same TCDM offset, in every cluster. Every cluster pulls its own block.
+ */
+inline void snrt_global_scatter(void *dst, const void *src, size_t size,
+                                uint32_t root) {
+    snrt_global_barrier();
+    if (snrt_is_dm_core()) {
+        const uint8_t *from = snrt_cluster_ptr(src, root);
+        snrt_dma_wait(snrt_dma_start_memcpy(
+            dst, from + snrt_cluster_idx() * size, size));
+    }
+    snrt_global_barrier();
+}
+
+/**
+ * @brief Copy `size` bytes of `src` of cluster `i` to block `i` of `dst` of
+ * cluster `root`, for all clusters
+ * @details Must be called by all cores of all clusters. `dst` may be in main
+ * memory, or in the TCDM of `root`, and must be the same address, or at the
+ * same TCDM offset, in every cluster. Every cluster pushes its own block.
+ */
+inline void snrt_global_gather(void *dst, const void *src, size_t size,
+                               uint32_t root) {
+    snrt_global_barrier();
+    if (snrt_is_dm_core()) {
+        uint8_t *to = snrt_cluster_ptr(dst, root);
+        snrt_dma_wait(snrt_dma_start_memcpy(
+            to + snrt_cluster_idx() * size, src, size));
+    }
+    snrt_global_barrier();
+}
+
+/**
+ * @brief Copy `size` bytes of `src` of cluster `i` to block `i` of `dst` of
+ * all clusters, for all clusters
+ * @details Must be called by all cores of all clusters. `dst` must be at the
+ * same offset in the TCDM of every cluster, `src` may be anywhere. Every
+ * cluster reads its `src` once into its own block of `dst`, and pushes the
+ * block from there to the other clusters, starting with the next one so that
+ * the clusters do not all write to the same TCDM at once.
+ */
+inline void snrt_global_all_gather(void *dst, const void *src, size_t size) {
+    snrt_global_barrier();
+    if (snrt_is_dm_core()) {
+        uint32_t n = snrt_cluster_num(), c = snrt_cluster_idx();
+        uint8_t *block = (uint8_t *)dst + c * size;
+        snrt_dma_wait(snrt_dma_start_memcpy(block, src, size));
+        for (uint32_t i = 1; i < n; i++)
+            snrt_dma_start_memcpy(snrt_remote_l1_ptr(block, (c + i) % n),
+                                  block, size);
+        snrt_dma_wait_all();
+    }
+    snrt_global_barrier();
 }
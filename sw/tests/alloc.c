@@ -0,0 +1,45 @@
+// Copyright 2024 KU Leuven.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "snrt.h"
+
+int main() {
+    if (snrt_cluster_core_idx() != 0) return 0;
+
+    int errors = 0;
+    size_t available = snrt_l1_available();
+    uint32_t base = (uint32_t)snrt_l1_next();
+
+    // Plain allocations are 8-byte aligned and contiguous
+    uint8_t *a = snrt_l1alloc(3);
+    uint8_t *b = snrt_l1alloc(8);
+    errors += (uint32_t)a != base;
+    errors += b != a + 8;
+
+    // Everything allocated in an arena is released by popping it
+    snrt_l1_arena_t outer = snrt_l1_arena_push();
+    uint8_t *c = snrt_l1alloc_aligned(100, 256);
+    errors += ((uint32_t)c & 255) != 0;
+    snrt_l1_arena_t inner = snrt_l1_arena_push();
+    uint8_t *d = snrt_l1alloc_bank(64, 5);
+    errors += ((uint32_t)d / SNRT_TCDM_BANK_WIDTH) % SNRT_TCDM_BANK_NUM != 5;
+    errors += d < c + 100;
+    size_t high_water = snrt_l1_high_water_mark();
+    errors += high_water < (uint32_t)d + 64 - snrt_l1_allocator()->base;
+    snrt_l1_arena_pop(inner);
+    errors += snrt_l1_next() != c + 104;
+    snrt_l1_arena_pop(outer);
+    errors += snrt_l1_next() != b + 8;
+
+    // The high-water mark survives releases
+    errors += snrt_l1_high_water_mark() != high_water;
+    errors += snrt_l1_available() != available - 16;
+
+    // The allocatable region ends below the stacks
+    uint32_t sp;
+    asm volatile("mv %0, sp" : "=r"(sp));
+    errors += base + available > sp;
+
+    return errors;
+}
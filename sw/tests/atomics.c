@@ -2,7 +2,8 @@
 // Licensed under the Apache License, Version 2.0, see LICENSE for details.
 // SPDX-License-Identifier: Apache-2.0
 
-/* Tests that a single core can do atomics */
+/* Tests that a single core can do atomics, and compares the mutexes under
+ * contention from all cores */
 
 #include <snrt.h>
 
@@ -172,6 +173,104 @@ uint32_t test_atomics(volatile uint32_t* atomic_var) {
     return nerrors;
 }
 
+//===============================================================
+// Mutex contention benchmark (all cores)
+//===============================================================
+
+#define MUTEX_ITERATIONS 32
+
+enum { MUTEX_TAS, MUTEX_TTAS, MUTEX_TICKET, MUTEX_MCS, MUTEX_NUM };
+
+static const char* mutex_names[MUTEX_NUM] = {"tas", "ttas", "ticket", "mcs"};
+
+typedef struct {
+    volatile uint32_t tas;
+    snrt_ticket_mutex_t ticket;
+    snrt_mcs_mutex_t mcs;
+    // Incremented in the critical section without atomics
+    volatile uint32_t counter;
+    // Sum of the acquire latencies of all cores
+    volatile uint32_t acquire_cycles;
+} mutex_bench_t;
+
+// Shares the benchmark state, allocated in L1 by core 0
+static mutex_bench_t* volatile mutex_bench;
+
+static inline void mutex_acquire(mutex_bench_t* b, uint32_t kind) {
+    switch (kind) {
+        case MUTEX_TAS:
+            snrt_mutex_acquire(&b->tas);
+            break;
+        case MUTEX_TTAS:
+            snrt_mutex_ttas_acquire(&b->tas);
+            break;
+        case MUTEX_TICKET:
+            snrt_mutex_ticket_acquire(&b->ticket);
+            break;
+        case MUTEX_MCS:
+            snrt_mutex_mcs_acquire(&b->mcs);
+            break;
+    }
+}
+
+static inline void mutex_release(mutex_bench_t* b, uint32_t kind) {
+    switch (kind) {
+        case MUTEX_TAS:
+        case MUTEX_TTAS:
+            snrt_mutex_release(&b->tas);
+            break;
+        case MUTEX_TICKET:
+            snrt_mutex_ticket_release(&b->ticket);
+            break;
+        case MUTEX_MCS:
+            snrt_mutex_mcs_release(&b->mcs);
+            break;
+    }
+}
+
+// All cores of the cluster take the mutex `MUTEX_ITERATIONS` times each. Core
+// 0 checks the critical sections did not overlap and reports the average
+// acquire latency and the TCDM accesses and congestion over the benchmark.
+uint32_t bench_mutex(mutex_bench_t* b, uint32_t kind) {
+    uint32_t core_id = snrt_cluster_core_idx();
+    uint32_t core_num = snrt_cluster_core_num();
+    uint32_t nerrors = 0;
+    uint32_t cycles = 0;
+
+    if (core_id == 0) {
+        b->counter = 0;
+        b->acquire_cycles = 0;
+        snrt_start_perf_counter(SNRT_PERF_CNT0, SNRT_PERF_CNT_TCDM_ACCESSED, 0);
+        snrt_start_perf_counter(SNRT_PERF_CNT1, SNRT_PERF_CNT_TCDM_CONGESTED,
+                                0);
+    }
+    snrt_cluster_hw_barrier();
+
+    for (uint32_t i = 0; i < MUTEX_ITERATIONS; i++) {
+        uint32_t start = snrt_mcycle();
+        mutex_acquire(b, kind);
+        cycles += snrt_mcycle() - start;
+        b->counter++;
+        mutex_release(b, kind);
+    }
+    __atomic_add_fetch(&b->acquire_cycles, cycles, __ATOMIC_RELAXED);
+    snrt_cluster_hw_barrier();
+
+    if (core_id == 0) {
+        snrt_stop_perf_counter(SNRT_PERF_CNT0);
+        snrt_stop_perf_counter(SNRT_PERF_CNT1);
+        if (b->counter != core_num * MUTEX_ITERATIONS) nerrors++;
+        printf("%s: %u cycles per acquire, %u TCDM accesses, %u congested\n",
+               mutex_names[kind],
+               b->acquire_cycles / (core_num * MUTEX_ITERATIONS),
+               snrt_get_perf_counter(SNRT_PERF_CNT0),
+               snrt_get_perf_counter(SNRT_PERF_CNT1));
+        snrt_reset_perf_counter(SNRT_PERF_CNT0);
+        snrt_reset_perf_counter(SNRT_PERF_CNT1);
+    }
+    return nerrors;
+}
+
 // Use at least two locations to test unaligned accesses
 #define NUM_SPM_LOCATIONS 2
 #define NUM_TCDM_LOCATIONS 2
@@ -197,9 +296,15 @@ int main() {
         for (int i = 0; i < NUM_SPM_LOCATIONS; ++i) {
             nerrors += test_atomics(&l3_a[i]);
         }
-    } else {
-        return 0;
+
+        mutex_bench = snrt_l1alloc(sizeof(mutex_bench_t));
+        snrt_memset(mutex_bench, 0, sizeof(mutex_bench_t));
     }
+    snrt_cluster_hw_barrier();
+
+    // Contention from all cores
+    for (uint32_t kind = 0; kind < MUTEX_NUM; kind++)
+        nerrors += bench_mutex(mutex_bench, kind);
 
     return nerrors;
 }
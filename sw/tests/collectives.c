@@ -0,0 +1,85 @@
+// Copyright 2024 KU Leuven.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Checks the broadcast, scatter, gather and all-gather collectives and
+// reports the bandwidth they deliver to all clusters together.
+
+#include "snrt.h"
+
+static uint8_t pattern(uint32_t block, uint32_t i) {
+    return (block * 31 + i) & 0xff;
+}
+
+static void fill(uint8_t *buf, uint32_t block, uint32_t size) {
+    for (uint32_t i = 0; i < size; i++) buf[i] = pattern(block, i);
+}
+
+static uint32_t check(const uint8_t *buf, uint32_t block, uint32_t size) {
+    uint32_t errors = 0;
+    for (uint32_t i = 0; i < size; i++) errors += buf[i] != pattern(block, i);
+    return errors;
+}
+
+static void report(const char *name, uint32_t size, uint32_t bytes,
+                   uint32_t cycles) {
+    if (snrt_is_dm_core() && snrt_cluster_idx() == 0)
+        printf("%s %u B: %u cycles, %u B/kcycle\n", name, size, cycles,
+               (uint32_t)((uint64_t)bytes * 1000 / cycles));
+}
+
+int main() {
+    uint32_t errors = 0;
+    uint32_t n = snrt_cluster_num(), c = snrt_cluster_idx();
+    int dm = snrt_is_dm_core();
+    uint32_t start, cycles;
+
+    // Main memory buffer of the root, seen by all clusters
+    uint8_t *l3 = snrt_l3_next();
+
+    for (uint32_t size = 1024; size <= 8192; size *= 8) {
+        // The buffers are at the same offset in every cluster
+        uint8_t *src = snrt_l1_next();
+        uint8_t *dst = src + size;
+
+        // One main memory read feeds all clusters
+        if (dm && c == 0) fill(l3, 0, size);
+        snrt_global_barrier();
+        start = snrt_mcycle();
+        snrt_global_broadcast(dst, l3, size, 0);
+        cycles = snrt_mcycle() - start;
+        if (dm) errors += check(dst, 0, size);
+        report("broadcast", size, n * size, cycles);
+
+        if (dm && c == 0)
+            for (uint32_t i = 0; i < n; i++) fill(l3 + i * size, i, size);
+        snrt_global_barrier();
+        start = snrt_mcycle();
+        snrt_global_scatter(dst, l3, size, 0);
+        cycles = snrt_mcycle() - start;
+        if (dm) errors += check(dst, c, size);
+        report("scatter", size, n * size, cycles);
+
+        if (dm) fill(src, c, size);
+        snrt_global_barrier();
+        start = snrt_mcycle();
+        snrt_global_gather(l3, src, size, 0);
+        cycles = snrt_mcycle() - start;
+        if (dm && c == 0)
+            for (uint32_t i = 0; i < n; i++)
+                errors += check(l3 + i * size, i, size);
+        report("gather", size, n * size, cycles);
+
+        start = snrt_mcycle();
+        snrt_global_all_gather(dst, src, size);
+        cycles = snrt_mcycle() - start;
+        if (dm)
+            for (uint32_t i = 0; i < n; i++)
+                errors += check(dst + i * size, i, size);
+        report("all-gather", size, n * n * size, cycles);
+
+        snrt_global_barrier();
+    }
+
+    return errors;
+}
@@ -0,0 +1,50 @@
+// Copyright 2024 KU Leuven.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <snrt.h>
+
+#define BUFFER_SIZE 1024
+
+// Lengths and offsets around the bus beat and the core fallback threshold
+static const uint32_t lengths[] = {0, 1, 7, 63, 64, 127, 128, 129, 300, 900};
+static const uint32_t offsets[] = {0, 1, 5, 64, 67};
+
+// Main memory buffer to copy from and to
+uint8_t buffer[BUFFER_SIZE];
+
+static uint32_t check(const uint8_t *ptr, uint32_t off, uint32_t len,
+                      uint8_t inside, uint8_t outside) {
+    uint32_t errors = 0;
+    for (uint32_t i = 0; i < BUFFER_SIZE; i++) {
+        uint8_t expected = (i >= off && i < off + len) ? inside : outside;
+        errors += ptr[i] != expected;
+    }
+    return errors;
+}
+
+int main() {
+    if (!snrt_is_dm_core()) return 0;
+    uint32_t errors = 0;
+    uint8_t *l1 = snrt_l1alloc(BUFFER_SIZE);
+
+    for (uint32_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+        for (uint32_t j = 0; j < sizeof(offsets) / sizeof(offsets[0]); j++) {
+            uint32_t len = lengths[i], off = offsets[j];
+
+            // Zeroing from the zero memory and filling from a seeded beat
+            snrt_core_memset(l1, 0xAA, BUFFER_SIZE);
+            snrt_dma_wait(snrt_dma_start_memset(l1 + off, 0, len));
+            errors += check(l1, off, len, 0, 0xAA);
+            snrt_dma_wait(snrt_dma_start_memset(l1 + off, 0x5A, len));
+            errors += check(l1, off, len, 0x5A, 0xAA);
+
+            // Copying between misaligned addresses in L1 and main memory
+            snrt_core_memset(buffer, 0x33, BUFFER_SIZE);
+            snrt_dma_wait(snrt_dma_start_memcpy(buffer + off, l1 + off, len));
+            errors += check(buffer, off, len, 0x5A, 0x33);
+        }
+    }
+
+    return errors;
+}
@@ -0,0 +1,93 @@
+// Copyright 2024 KU Leuven.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Checks N-dimensional DMA transfers and hand-written loops of 2D transfers
+// against the elements of NHWC tiles of a tensor in main memory, and reports
+// the achieved bandwidth of both.
+
+#include "snrt.h"
+
+#define N 2
+#define H 8
+#define W 8
+#define C 16
+
+#define TILE_N 2
+#define TILE_H 4
+#define TILE_W 4
+
+double tensor[N * H * W * C];
+
+// Copy a TILE_N x TILE_H x TILE_W x tile_c tile into L1 with loops of 2D
+// transfers over the pixels of a row, as kernels do by hand
+static void copy_loops(double *dst, uint32_t tile_c) {
+    for (uint32_t n = 0; n < TILE_N; n++) {
+        for (uint32_t h = 0; h < TILE_H; h++) {
+            snrt_dma_start_2d(dst + (n * TILE_H + h) * TILE_W * tile_c,
+                              tensor + (n * H + h) * W * C,
+                              tile_c * sizeof(double), tile_c * sizeof(double),
+                              C * sizeof(double), TILE_W);
+        }
+    }
+}
+
+// Count the elements of `tile` which differ from the tile in `tensor`
+static uint32_t check(const double *tile, uint32_t tile_c) {
+    uint32_t errors = 0;
+    for (uint32_t n = 0; n < TILE_N; n++)
+        for (uint32_t h = 0; h < TILE_H; h++)
+            for (uint32_t w = 0; w < TILE_W; w++)
+                for (uint32_t c = 0; c < tile_c; c++)
+                    errors +=
+                        tile[((n * TILE_H + h) * TILE_W + w) * tile_c + c] !=
+                        tensor[((n * H + h) * W + w) * C + c];
+    return errors;
+}
+
+static void copy_nd(double *dst, uint32_t tile_c) {
+    size_t repeat[3] = {TILE_W, TILE_H, TILE_N};
+    size_t dst_stride[3] = {tile_c * sizeof(double),
+                            TILE_W * tile_c * sizeof(double),
+                            TILE_H * TILE_W * tile_c * sizeof(double)};
+    size_t src_stride[3] = {C * sizeof(double), W * C * sizeof(double),
+                            H * W * C * sizeof(double)};
+    snrt_dma_start_nd(dst, tensor, tile_c * sizeof(double), 3, repeat,
+                      dst_stride, src_stride);
+}
+
+int main() {
+    if (!snrt_is_dm_core()) return 0;
+
+    uint32_t errors = 0;
+    uint32_t tile_size = TILE_N * TILE_H * TILE_W * C;
+    double *ref = snrt_l1alloc(tile_size * sizeof(double));
+    double *res = snrt_l1alloc(tile_size * sizeof(double));
+
+    for (uint32_t i = 0; i < N * H * W * C; i++) tensor[i] = i;
+
+    // All channels, where rows of pixels are contiguous, and half of them
+    for (uint32_t tile_c = C; tile_c >= C / 2; tile_c /= 2) {
+        uint32_t bytes = TILE_N * TILE_H * TILE_W * tile_c * sizeof(double);
+        snrt_core_memset(ref, 0xFF, bytes);
+        snrt_core_memset(res, 0xFF, bytes);
+
+        uint32_t start = snrt_mcycle();
+        copy_loops(ref, tile_c);
+        snrt_dma_wait_all();
+        uint32_t loops = snrt_mcycle() - start;
+
+        start = snrt_mcycle();
+        copy_nd(res, tile_c);
+        snrt_dma_wait_all();
+        uint32_t nd = snrt_mcycle() - start;
+
+        errors += check(ref, tile_c) + check(res, tile_c);
+
+        printf("%u channels: loops %u cycles (%u B/kcycle), nd %u cycles (%u "
+               "B/kcycle)\n",
+               tile_c, loops, bytes * 1000 / loops, nd, bytes * 1000 / nd);
+    }
+
+    return errors;
+}
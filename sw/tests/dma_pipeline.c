@@ -0,0 +1,66 @@
+// Copyright 2024 KU Leuven.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "snrt.h"
+
+// z = a * x + y on ROWS x COLS matrices in main memory, in tiles of
+// ROWS x TILE_COLS elements
+#define ROWS 8
+#define COLS 64
+#define TILE_COLS 8
+
+double a = 3;
+double x[ROWS * COLS], y[ROWS * COLS], z[ROWS * COLS];
+snrt_dma_pipe_operand_t operands[3];
+snrt_dma_pipe_t axpy_pipe;
+
+static void axpy(snrt_dma_pipe_t *pipe, uint32_t tile, void *arg) {
+    double a = *(double *)arg;
+    double *bx = snrt_dma_pipe_buffer(pipe, 0, tile);
+    double *by = snrt_dma_pipe_buffer(pipe, 1, tile);
+    double *bz = snrt_dma_pipe_buffer(pipe, 2, tile);
+    for (uint32_t i = snrt_cluster_core_idx(); i < ROWS * TILE_COLS;
+         i += snrt_cluster_compute_core_num())
+        bz[i] = a * bx[i] + by[i];
+}
+
+int main() {
+    int errors = 0;
+
+    for (uint32_t depth = 2; depth <= 3; depth++) {
+        if (snrt_is_dm_core()) {
+            for (uint32_t i = 0; i < ROWS * COLS; i++) {
+                x[i] = i + depth;
+                y[i] = 2 * i;
+                z[i] = 0;
+            }
+            for (uint32_t i = 0; i < 3; i++) {
+                operands[i].l3 = i == 0 ? x : i == 1 ? y : z;
+                operands[i].tile_stride = TILE_COLS * sizeof(double);
+                operands[i].size = TILE_COLS * sizeof(double);
+                operands[i].stride[0] = COLS * sizeof(double);
+                operands[i].repeat[0] = ROWS;
+                operands[i].repeat[1] = 1;
+                operands[i].output = i == 2;
+            }
+            axpy_pipe.operands = operands;
+            axpy_pipe.num_operands = 3;
+            axpy_pipe.num_tiles = COLS / TILE_COLS;
+            axpy_pipe.depth = depth;
+            axpy_pipe.compute = axpy;
+            axpy_pipe.arg = &a;
+        }
+        snrt_cluster_hw_barrier();
+
+        snrt_dma_pipe_run(&axpy_pipe);
+
+        if (snrt_cluster_core_idx() == 0) {
+            for (uint32_t i = 0; i < ROWS * COLS; i++)
+                errors += z[i] != a * x[i] + y[i];
+        }
+        snrt_cluster_hw_barrier();
+    }
+
+    return errors;
+}
@@ -0,0 +1,49 @@
+// Copyright 2024 KU Leuven.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Checks the flat and tree global barriers and compares their latency.
+
+#include "snrt.h"
+
+#define ITERATIONS 16
+
+// Number of clusters which passed each barrier
+volatile uint32_t arrived[2 * ITERATIONS];
+
+static void arrive(uint32_t i) {
+    if (snrt_is_dm_core())
+        __atomic_add_fetch(&arrived[i], 1, __ATOMIC_RELAXED);
+}
+
+int main() {
+    uint32_t errors = 0;
+    uint32_t start, flat, tree;
+
+    // Nobody may leave a barrier before all clusters counted themselves in
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        arrive(i);
+        snrt_global_tree_barrier();
+        errors += arrived[i] != snrt_cluster_num();
+        arrive(ITERATIONS + i);
+        snrt_global_flat_barrier();
+        errors += arrived[ITERATIONS + i] != snrt_cluster_num();
+    }
+
+    // Latency, averaged over back-to-back barriers
+    snrt_global_barrier();
+    start = snrt_mcycle();
+    for (uint32_t i = 0; i < ITERATIONS; i++) snrt_global_flat_barrier();
+    flat = (snrt_mcycle() - start) / ITERATIONS;
+
+    snrt_global_barrier();
+    start = snrt_mcycle();
+    for (uint32_t i = 0; i < ITERATIONS; i++) snrt_global_tree_barrier();
+    tree = (snrt_mcycle() - start) / ITERATIONS;
+
+    if (snrt_global_core_idx() == 0)
+        printf("%u clusters: flat barrier %u cycles, tree barrier %u cycles\n",
+               snrt_cluster_num(), flat, tree);
+
+    return errors;
+}
@@ -0,0 +1,99 @@
+// Copyright 2024 KU Leuven.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Runs a loop whose iterations grow in length, like the rows of a triangular
+// matrix, with static, dynamic and guided schedules, and compares the time to
+// completion and the balance of the work across threads.
+
+#include "snrt.h"
+
+#define ROWS 256
+#define CHUNK 4
+#define NTHREADS 8
+
+static double *x, *y;
+static uint32_t busy[NTHREADS];
+
+// Iteration `i` takes `i + 1` multiply-adds
+static inline void row(unsigned i) {
+    double acc = 0;
+    for (unsigned j = 0; j <= i; j++) acc += x[j] * (double)(i + 1);
+    y[i] = acc;
+}
+
+void __attribute__((noinline)) static_schedule(void) {
+#pragma omp parallel
+    {
+        uint32_t start = snrt_mcycle();
+#pragma omp for schedule(static) nowait
+        for (unsigned i = 0; i < ROWS; i++) row(i);
+        busy[omp_get_thread_num()] = snrt_mcycle() - start;
+    }
+}
+
+void __attribute__((noinline)) dynamic_schedule(void) {
+#pragma omp parallel
+    {
+        uint32_t start = snrt_mcycle();
+#pragma omp for schedule(dynamic, CHUNK) nowait
+        for (unsigned i = 0; i < ROWS; i++) row(i);
+        busy[omp_get_thread_num()] = snrt_mcycle() - start;
+    }
+}
+
+void __attribute__((noinline)) guided_schedule(void) {
+#pragma omp parallel
+    {
+        uint32_t start = snrt_mcycle();
+#pragma omp for schedule(guided, CHUNK) nowait
+        for (unsigned i = 0; i < ROWS; i++) row(i);
+        busy[omp_get_thread_num()] = snrt_mcycle() - start;
+    }
+}
+
+static unsigned run(const char *name, void (*schedule)(void)) {
+    unsigned errs = 0;
+
+    for (unsigned i = 0; i < ROWS; i++) y[i] = 0;
+
+    uint32_t start = snrt_mcycle();
+    schedule();
+    uint32_t cycles = snrt_mcycle() - start;
+
+    // Slowest over fastest thread, in percent
+    uint32_t min = busy[0], max = busy[0];
+    for (unsigned t = 1; t < NTHREADS; t++) {
+        if (busy[t] < min) min = busy[t];
+        if (busy[t] > max) max = busy[t];
+    }
+    printf("%-8s %6d cycles, imbalance %d%%\n", name, cycles,
+           min ? 100 * max / min : 0);
+
+    // x[j] = 1, so row i sums to (i + 1)^2
+    for (unsigned i = 0; i < ROWS; i++)
+        if (y[i] != (double)((i + 1) * (i + 1))) errs++;
+    if (errs) printf("Error [%s]: %d mismatches\n", name, errs);
+    return errs ? 1 : 0;
+}
+
+int main() {
+    unsigned core_idx = snrt_cluster_core_idx();
+    unsigned err = 0;
+
+    // Only core 0 executes the statements below this function
+    __snrt_omp_bootstrap(core_idx);
+
+    x = snrt_l1alloc(sizeof(double) * ROWS);
+    y = snrt_l1alloc(sizeof(double) * ROWS);
+    for (unsigned i = 0; i < ROWS; i++) x[i] = 1.0;
+
+    printf("Dynamic schedule test\n");
+    err += run("static", static_schedule);
+    err += run("dynamic", dynamic_schedule);
+    err += run("guided", guided_schedule);
+
+    // exit
+    __snrt_omp_destroy(core_idx);
+    return err;
+}
@@ -0,0 +1,57 @@
+// Copyright 2024 KU Leuven.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Profiles nested regions on all harts with more events than counters, such
+// that the regions run once per event group, and checks the records.
+
+#include "snrt.h"
+
+#define NUM_EVENTS (SNRT_PERF_N_CNT + 4)
+
+int main() {
+    uint32_t errors = 0;
+    snrt_prof_event_t events[NUM_EVENTS];
+
+    for (uint32_t i = 0; i < NUM_EVENTS; i++) {
+        events[i].type = i % (SNRT_PERF_CNT_ICACHE_STALL + 1);
+        events[i].hart = i % snrt_cluster_core_num();
+    }
+    snrt_prof_init(events, NUM_EVENTS);
+
+    uint32_t num_groups = snrt_prof_num_groups();
+    for (uint32_t group = 0; group < num_groups; group++) {
+        snrt_prof_select_group(group);
+        snrt_prof_begin("outer");
+        snrt_prof_begin("work");
+        volatile uint32_t *ptr = (void *)snrt_l1_next();
+        for (uint32_t i = 0; i < 16; i++) ptr[snrt_cluster_core_idx()] = i;
+        snrt_prof_end();
+        snrt_cluster_hw_barrier();
+        snrt_prof_end();
+    }
+    snrt_global_barrier();
+
+    // Every region of every hart is closed, in order, and counts its group
+    if (snrt_global_core_idx() == 0) {
+        uint32_t expected = 2 * num_groups * snrt_global_core_num();
+        uint32_t offset = 0, num = 0;
+        while (offset < snrt_prof_buffer.used) {
+            snrt_prof_record_t *record =
+                (snrt_prof_record_t *)((uint8_t *)snrt_prof_buffer.data +
+                                       offset);
+            uint32_t first = record->group * SNRT_PERF_N_CNT;
+            uint32_t counters = NUM_EVENTS - first < SNRT_PERF_N_CNT
+                                    ? NUM_EVENTS - first
+                                    : SNRT_PERF_N_CNT;
+            errors += !record->closed || record->group >= num_groups;
+            offset += sizeof(snrt_prof_record_t) + counters * sizeof(uint32_t);
+            num++;
+        }
+        errors += num != expected || snrt_prof_buffer.dropped;
+        printf("%u regions in %u groups, %u bytes\n", num, num_groups,
+               snrt_prof_buffer.used);
+    }
+
+    return errors;
+}
@@ -0,0 +1,148 @@
+// Copyright 2024 KU Leuven.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Checks the reduction within a cluster and the global reductions for all
+// element types, operators and algorithms, on a length which is neither a
+// multiple of the number of cores nor of the chunk size, nor for fp32 and fp16
+// of a 64-bit word, and compares the latency of both global algorithms.
+
+#include "snrt.h"
+
+#define LEN 1001
+
+static snrt_dtype_t types[] = {SNRT_FP64, SNRT_FP32, SNRT_FP16, SNRT_INT32};
+
+// Small integers, exact in all element types
+static int32_t value(uint32_t cluster, uint32_t i) {
+    return (int32_t)((cluster * 7 + i * 3) % 11) - 4;
+}
+
+static uint16_t int_to_fp16(int32_t v) {
+    uint16_t sign = v < 0 ? 0x8000 : 0;
+    uint32_t m = v < 0 ? -v : v, e = 0;
+    if (!m) return sign;
+    while (m >> (e + 1)) e++;
+    return sign | (e + 15) << 10 | ((m << (10 - e)) & 0x3ff);
+}
+
+static int32_t fp16_to_int(uint16_t h) {
+    uint32_t e = (h >> 10) & 0x1f;
+    int32_t m = e ? (0x400 | (h & 0x3ff)) >> (25 - e) : 0;
+    return h & 0x8000 ? -m : m;
+}
+
+static void set(void *buf, snrt_dtype_t type, uint32_t i, int32_t v) {
+    switch (type) {
+        case SNRT_FP64:
+            ((double *)buf)[i] = v;
+            break;
+        case SNRT_FP32:
+            ((float *)buf)[i] = v;
+            break;
+        case SNRT_FP16:
+            ((uint16_t *)buf)[i] = int_to_fp16(v);
+            break;
+        case SNRT_INT32:
+            ((int32_t *)buf)[i] = v;
+            break;
+    }
+}
+
+static int32_t get(void *buf, snrt_dtype_t type, uint32_t i) {
+    switch (type) {
+        case SNRT_FP64:
+            return ((double *)buf)[i];
+        case SNRT_FP32:
+            return ((float *)buf)[i];
+        case SNRT_FP16:
+            return fp16_to_int(((uint16_t *)buf)[i]);
+        default:
+            return ((int32_t *)buf)[i];
+    }
+}
+
+static int32_t combine(snrt_reduce_op_t op, int32_t r, int32_t v) {
+    if (op == SNRT_REDUCE_SUM) return r + v;
+    if (op == SNRT_REDUCE_MAX) return v > r ? v : r;
+    return v < r ? v : r;
+}
+
+static int32_t expected(snrt_reduce_op_t op, uint32_t i) {
+    int32_t r = value(0, i);
+    for (uint32_t c = 1; c < snrt_cluster_num(); c++)
+        r = combine(op, r, value(c, i));
+    return r;
+}
+
+int main() {
+    uint32_t errors = 0;
+    uint32_t bytes = LEN * sizeof(double);
+    uint32_t start, cycles[2];
+
+    // The buffers are at the same offset in every cluster. A guard word
+    // follows every buffer.
+    uint8_t *src = snrt_l1_next();
+    uint8_t *dst = src + ALIGN_UP(bytes, 8) + 8;
+    uint8_t *aux = dst + ALIGN_UP(bytes, 8) + 8;
+    snrt_cluster_hw_barrier();
+    if (snrt_is_dm_core()) snrt_l1alloc(3 * (ALIGN_UP(bytes, 8) + 8));
+
+    // Reduction of two buffers by the compute cores of every cluster
+    for (uint32_t t = 0; t < sizeof(types) / sizeof(types[0]); t++) {
+        uint32_t size = snrt_dtype_size(types[t]);
+        for (uint32_t op = SNRT_REDUCE_SUM; op <= SNRT_REDUCE_MIN; op++) {
+            if (snrt_is_dm_core()) {
+                for (uint32_t i = 0; i < LEN; i++) {
+                    set(src, types[t], i, value(0, i));
+                    set(aux, types[t], i, value(1, i));
+                }
+                snrt_core_memset(dst, 0xA5, LEN * size + 8);
+            }
+            snrt_cluster_hw_barrier();
+
+            if (snrt_is_compute_core())
+                snrt_cluster_reduce(dst, src, aux, LEN, types[t], op);
+            snrt_cluster_hw_barrier();
+
+            if (snrt_is_dm_core()) {
+                for (uint32_t i = 0; i < LEN; i++)
+                    errors += get(dst, types[t], i) !=
+                              combine(op, value(0, i), value(1, i));
+                for (uint32_t i = LEN * size; i < LEN * size + 8; i++)
+                    errors += dst[i] != 0xA5;
+            }
+        }
+    }
+
+    for (uint32_t t = 0; t < sizeof(types) / sizeof(types[0]); t++) {
+        for (uint32_t op = SNRT_REDUCE_SUM; op <= SNRT_REDUCE_MIN; op++) {
+            for (uint32_t alg = SNRT_REDUCE_TREE; alg <= SNRT_REDUCE_RING;
+                 alg++) {
+                if (snrt_is_dm_core())
+                    for (uint32_t i = 0; i < LEN; i++)
+                        set(src, types[t], i, value(snrt_cluster_idx(), i));
+
+                snrt_global_reduction(dst, src, LEN, types[t], op, alg);
+
+                if (snrt_is_dm_core() && snrt_cluster_idx() == 0)
+                    for (uint32_t i = 0; i < LEN; i++)
+                        errors += get(dst, types[t], i) != expected(op, i);
+            }
+        }
+    }
+
+    // Latency of a sum of doubles with both algorithms
+    for (uint32_t alg = SNRT_REDUCE_TREE; alg <= SNRT_REDUCE_RING; alg++) {
+        snrt_global_barrier();
+        start = snrt_mcycle();
+        snrt_global_reduction(dst, src, LEN, SNRT_FP64, SNRT_REDUCE_SUM, alg);
+        cycles[alg - SNRT_REDUCE_TREE] = snrt_mcycle() - start;
+    }
+
+    if (snrt_global_core_idx() == 0)
+        printf("%u clusters, %u B: tree %u cycles, ring %u cycles\n",
+               snrt_cluster_num(), bytes, cycles[0], cycles[1]);
+
+    return errors;
+}
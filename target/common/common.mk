@@ -28,6 +28,7 @@ GENTRACE_PY      ?= $(UTIL_DIR)/trace/gen_trace.py
 ANNOTATE_PY      ?= $(UTIL_DIR)/trace/annotate.py
 EVENTS_PY        ?= $(UTIL_DIR)/trace/events.py
 PERF_CSV_PY      ?= $(UTIL_DIR)/trace/perf_csv.py
+PROF_CSV_PY      ?= $(UTIL_DIR)/trace/prof_csv.py
 LAYOUT_EVENTS_PY ?= $(UTIL_DIR)/trace/layout_events.py
 EVENTVIS_PY      ?= $(UTIL_DIR)/trace/eventvis.py
 
@@ -57,6 +58,16 @@ FESVR_VERSION ?= 35d50bc40e59ea1d5566fbd3d9226023821b1bb6
 VLT_BENDER   += -t rtl
 VLT_SOURCES   = $(shell ${BENDER} script flist ${VLT_BENDER} | ${SED_SRCS})
 VLT_BUILDDIR := work-vlt
+# Number of threads the verilated model is evaluated with. Multi-threaded
+# variants are built in their own directory and binary so that they can be
+# compared against the single-threaded one.
+VLT_NUM_THREADS ?= 1
+VLT_SUFFIX    :=
+ifneq ($(VLT_NUM_THREADS), 1)
+	VLT_SUFFIX   := -mt$(VLT_NUM_THREADS)
+	VLT_BUILDDIR := work-vlt$(VLT_SUFFIX)
+	VLT_FLAGS    += --threads $(VLT_NUM_THREADS)
+endif
 VLT_FESVR     = $(VLT_BUILDDIR)/riscv-isa-sim
 ifeq ($(VERILATOR_VERSION), 5)
 	VLT_FLAGS += --timing
@@ -78,6 +89,13 @@ else
 	VLT_CXXSTD_FLAGS += -std=c++14 -pthread
 endif
 VLT_CFLAGS   += ${VLT_CXXSTD_FLAGS} -I ${VLT_BUILDDIR} -I $(VLT_ROOT)/include -I $(VLT_ROOT)/include/vltstd -I $(VLT_FESVR)/include -I $(TB_DIR) -I ${MKFILE_DIR}/test
+# Verilator 4 lays out its runtime differently with threads, so the runtime
+# and testbench objects must be built threaded like the model
+ifneq ($(VERILATOR_VERSION), 5)
+ifneq ($(VLT_NUM_THREADS), 1)
+	VLT_CFLAGS += -DVL_THREADED
+endif
+endif
 
 ANNOTATE_FLAGS ?= -q --keep-time
 
@@ -116,6 +134,18 @@ VLOGAN_FLAGS += -kdb
 VHDLAN_FLAGS := -full64
 VHDLAN_FLAGS += -kdb
 
+# Emit the per-hart instruction traces as binary records through DPI instead
+# of formatting text in the RTL. `make traces` decodes them with `TRACE_DECODE`.
+TRACE_BINARY ?= 1
+TRACE_DECODE ?= bin/trace_decode
+ifeq ($(TRACE_BINARY), 1)
+	VLT_FLAGS    += +define+SNITCH_TRACE_BINARY
+	VLT_CFLAGS   += -DSNITCH_TRACE_BINARY
+	TB_CC_FLAGS  += -DSNITCH_TRACE_BINARY
+	VLOG_FLAGS   += +define+SNITCH_TRACE_BINARY
+	VLOGAN_FLAGS += +define+SNITCH_TRACE_BINARY
+endif
+
 # default on target `all`
 all:
 
@@ -229,7 +259,8 @@ endef
 # Traces #
 ##########
 
-DASM_TRACES      = $(shell (ls $(LOGS_DIR)/trace_hart_*.dasm 2>/dev/null))
+BIN_TRACES       = $(shell (ls $(LOGS_DIR)/trace_hart_*.bin 2>/dev/null))
+DASM_TRACES      = $(sort $(shell (ls $(LOGS_DIR)/trace_hart_*.dasm 2>/dev/null)) $(BIN_TRACES:.bin=.dasm))
 TXT_TRACES       = $(shell (echo $(DASM_TRACES) | sed 's/\.dasm/\.txt/g'))
 PERF_TRACES      = $(shell (echo $(DASM_TRACES) | sed 's/trace_hart/hart/g' | sed 's/.dasm/_perf.json/g'))
 ANNOTATED_TRACES = $(shell (echo $(DASM_TRACES) | sed 's/\.dasm/\.s/g'))
@@ -239,16 +270,23 @@ GENTRACE_OUTPUTS = $(TXT_TRACES) $(PERF_TRACES)
 ANNOTATE_OUTPUTS = $(ANNOTATED_TRACES)
 PERF_CSV         = $(LOGS_DIR)/perf.csv
 EVENT_CSV        = $(LOGS_DIR)/event.csv
+PROF_BIN         = $(LOGS_DIR)/prof.bin
+PROF_CSV         = $(LOGS_DIR)/prof.csv
 TRACE_CSV        = $(LOGS_DIR)/trace.csv
 TRACE_JSON       = $(LOGS_DIR)/trace.json
 
-.PHONY: traces annotate perf-csv event-csv layout
+.PHONY: traces annotate perf-csv event-csv prof-csv layout
 traces: $(GENTRACE_OUTPUTS)
 annotate: $(ANNOTATE_OUTPUTS)
 perf-csv: $(PERF_CSV)
 event-csv: $(EVENT_CSV)
+prof-csv: $(PROF_CSV)
 layout: $(TRACE_CSV) $(TRACE_JSON)
 
+# Decode the binary traces written with `TRACE_BINARY=1`
+$(LOGS_DIR)/trace_hart_%.dasm: $(LOGS_DIR)/trace_hart_%.bin $(TRACE_DECODE)
+	$(TRACE_DECODE) $< $@
+
 $(LOGS_DIR)/trace_hart_%.txt $(LOGS_DIR)/hart_%_perf.json: $(LOGS_DIR)/trace_hart_%.dasm $(GENTRACE_PY)
 	$(DASM) < $< | $(PYTHON) $(GENTRACE_PY) --permissive -d $(LOGS_DIR)/hart_$*_perf.json > $(LOGS_DIR)/trace_hart_$*.txt
 
@@ -266,6 +304,11 @@ $(PERF_CSV): $(PERF_TRACES) $(PERF_CSV_PY)
 $(EVENT_CSV): $(PERF_TRACES) $(PERF_CSV_PY)
 	$(PYTHON) $(PERF_CSV_PY) -o $@ -i $(PERF_TRACES) --filter tstart tend
 
+# Decode the region profiler records, written to $(PROF_BIN) by a simulation
+# run with the `--map` argument printed by `$(PROF_CSV_PY) map`
+$(PROF_CSV): $(PROF_BIN) $(PROF_CSV_PY)
+	$(PYTHON) $(PROF_CSV_PY) decode -o $@ $(PROF_BIN)
+
 $(TRACE_CSV): $(EVENT_CSV) $(LAYOUT_FILE) $(LAYOUT_EVENTS_PY)
 	$(PYTHON) $(LAYOUT_EVENTS_PY) $(LAYOUT_EVENTS_FLAGS) $(EVENT_CSV) $(LAYOUT_FILE) -o $@
 
@@ -10,6 +10,7 @@
 
 import os
 import sys
+import mmap
 import tempfile
 import subprocess
 import struct
@@ -18,6 +19,12 @@ import functools
 
 class SnitchSim:
 
+    # Control operations of the clock loop and the reasons it stops for, see
+    # `sim_ctrl.hh`. These require a Verilator simulator.
+    CONTROL_OPCODES = {'pause': 6, 'resume': 7, 'run': 8, 'break_pc': 9, 'break_write': 10,
+                       'time': 11, 'checkpoint': 12}
+    STOP_REASONS = ['paused', 'pc_break', 'write_break', 'finished', 'unsupported']
+
     def __init__(self, sim_bin: str, snitch_bin: str, log: str = None):
         self.sim_bin = sim_bin
         self.snitch_bin = snitch_bin
@@ -25,7 +32,7 @@ class SnitchSim:
         self.tmpdir = None
         self.log = open(log, 'w+') if log else log
 
-    def start(self):
+    def start(self, paused: bool = False):
         # Create FIFOs
         self.tmpdir = tempfile.TemporaryDirectory()
         tx_fd = os.path.join(self.tmpdir.name, 'tx')
@@ -34,7 +41,8 @@ class SnitchSim:
         os.mkfifo(rx_fd)
         # Start simulator process
         ipc_arg = f'--ipc,{tx_fd},{rx_fd}'
-        self.sim = subprocess.Popen([self.sim_bin, self.snitch_bin, ipc_arg], stdout=self.log)
+        args = [self.sim_bin, self.snitch_bin, ipc_arg] + (['--paused'] if paused else [])
+        self.sim = subprocess.Popen(args, stdout=self.log)
         # Open FIFOs
         self.tx = open(tx_fd, 'wb', buffering=0)  # Unbuffered
         self.rx = open(rx_fd, 'rb')
@@ -73,6 +81,69 @@ class SnitchSim:
         bytestring = self.rx.read(4)
         return int.from_bytes(bytestring, byteorder='little')
 
+    # Wait until any (or all, if `wait_all`) of the polled 32b words differ from
+    # their expected value under the mask. `polls` is a list of
+    # `(addr, mask32, exp32)` tuples; returns the last read word of each.
+    @__sim_active
+    def poll_multi(self, polls: list, wait_all: bool = False) -> list:
+        op = struct.pack('=QQQ', 5 if wait_all else 4, len(polls), 0)
+        entries = b''.join(struct.pack('=QLL', *p) for p in polls)
+        self.tx.write(op + entries)
+        bytestring = self.rx.read(4 * len(polls))
+        return list(struct.unpack(f'={len(polls)}L', bytestring))
+
+    def _control(self, op: str, addr: int = 0, length: int = 0, data: bytes = b''):
+        self.tx.write(struct.pack('=QQQ', self.CONTROL_OPCODES[op], addr, length) + data)
+        if op in ('pause', 'run', 'break_pc', 'time', 'checkpoint'):
+            return struct.unpack('=QQ', self.rx.read(16))
+
+    # Pause the clock loop at the end of the current cycle. Returns the cycle
+    # and the reason it stopped for.
+    @__sim_active
+    def pause(self):
+        cycle, reason = self._control('pause')
+        return cycle, self.STOP_REASONS[reason]
+
+    # Let the clock loop run freely again
+    @__sim_active
+    def resume(self):
+        self._control('resume')
+
+    # Run for `cycles` cycles, or until a breakpoint if zero, and pause again.
+    # Returns the cycle and the reason the simulation stopped for.
+    @__sim_active
+    def run(self, cycles: int = 0):
+        cycle, reason = self._control('run', cycles)
+        return cycle, self.STOP_REASONS[reason]
+
+    def step(self, cycles: int = 1):
+        return self.run(cycles)
+
+    # Pause once an instruction at `pc` retires (requires binary traces)
+    @__sim_active
+    def break_pc(self, pc: int, enable: bool = True):
+        _, reason = self._control('break_pc', pc, int(enable))
+        if self.STOP_REASONS[reason] == 'unsupported' and enable:
+            raise RuntimeError('PC breakpoints need a simulator built with TRACE_BINARY=1')
+
+    # Pause once the DUT writes to `[addr, addr + length)`; a zero length
+    # clears the breakpoints at `addr`
+    @__sim_active
+    def break_write(self, addr: int, length: int = 4):
+        self._control('break_write', addr, length)
+
+    # Returns the current cycle and simulation time
+    @__sim_active
+    def time(self):
+        return self._control('time')
+
+    # Pause and save a checkpoint to `path`, see `--restore`. Returns whether
+    # the checkpoint was saved.
+    @__sim_active
+    def checkpoint(self, path: str) -> bool:
+        path = path.encode()
+        return bool(self._control('checkpoint', 0, len(path), path)[1])
+
     # Simulator can exit only once TX FIFO closes
     @__sim_active
     def finish(self, wait_for_sim: bool = True):
@@ -86,6 +157,131 @@ class SnitchSim:
         self.sim = None
 
 
+class SnitchSimShm(SnitchSim):
+    """IPC client using the shared-memory transport of `tb_lib`.
+
+    Commands are passed through a single-producer single-consumer ring and
+    data through a bulk window in a shared memory region, so a transfer of up
+    to `data_size` bytes costs one copy on either side instead of a stream of
+    FIFO blocks.
+    """
+
+    MAGIC = 0x4350494d48534e53
+    OPCODES = {'read': 0, 'write': 1, 'poll': 2, 'exit': 3, 'poll_any': 4, 'poll_all': 5,
+               **SnitchSim.CONTROL_OPCODES}
+    HDR = struct.Struct('=8Q')
+    SLOT = struct.Struct('=8Q')
+    HEAD_OFFSET = 32
+    TAIL_OFFSET = 40
+
+    def __init__(self, sim_bin: str, snitch_bin: str, log: str = None,
+                 ring_size: int = 64, data_size: int = 64 << 20):
+        super().__init__(sim_bin, snitch_bin, log)
+        assert ring_size & (ring_size - 1) == 0, 'Ring size must be a power of two'
+        self.ring_size = ring_size
+        self.data_size = data_size
+        self.head = 0
+
+    def start(self, paused: bool = False):
+        # Prefer a tmpfs-backed location for the shared region
+        shm_dir = '/dev/shm' if os.path.isdir('/dev/shm') else None
+        self.tmpdir = tempfile.TemporaryDirectory(dir=shm_dir)
+        shm_path = os.path.join(self.tmpdir.name, 'ipc')
+        self.data_offset = -(-(self.HDR.size + self.ring_size * self.SLOT.size) // 4096) * 4096
+        with open(shm_path, 'w+b') as f:
+            f.truncate(self.data_offset + self.data_size)
+            self.shm = mmap.mmap(f.fileno(), self.data_offset + self.data_size)
+        self.HDR.pack_into(self.shm, 0, self.MAGIC, self.ring_size, self.data_offset,
+                           self.data_size, 0, 0, 0, 0)
+        self.window = memoryview(self.shm)[self.data_offset:]
+        # Start simulator process
+        ipc_arg = f'--ipc-shm,{shm_path}'
+        args = [self.sim_bin, self.snitch_bin, ipc_arg] + (['--paused'] if paused else [])
+        self.sim = subprocess.Popen(args, stdout=self.log)
+
+    def _submit(self, op: str, addr: int = 0, length: int = 0, wait: bool = True):
+        slot = self.HDR.size + (self.head % self.ring_size) * self.SLOT.size
+        self.SLOT.pack_into(self.shm, slot, self.OPCODES[op], addr, length, 0, 0, 0, 0, 0)
+        self.head += 1
+        # Publish the slot only after its contents are in place
+        struct.pack_into('=Q', self.shm, self.HEAD_OFFSET, self.head)
+        if wait:
+            # Yield between checks so the simulator can progress on busy hosts
+            while struct.unpack_from('=Q', self.shm, self.TAIL_OFFSET)[0] < self.head:
+                os.sched_yield()
+            if self.SLOT.unpack_from(self.shm, slot)[6]:
+                raise ValueError(f'Simulator rejected `{op}` operation outside the data window')
+        return slot
+
+    def _control(self, op: str, addr: int = 0, length: int = 0, data: bytes = b''):
+        self.window[:len(data)] = data
+        slot = self._submit(op, addr, length)
+        return self.SLOT.unpack_from(self.shm, slot)[4:6]
+
+    def _chunks(self, length: int):
+        for offset in range(0, length, self.data_size):
+            yield offset, min(self.data_size, length - offset)
+
+    @SnitchSim._SnitchSim__sim_active
+    def read_into(self, addr: int, out):
+        """Read `len(out)` bytes into a writable buffer, e.g. a numpy array."""
+        out = memoryview(out).cast('B')
+        for offset, n in self._chunks(len(out)):
+            self._submit('read', addr + offset, n)
+            out[offset:offset + n] = self.window[:n]
+        return out
+
+    @SnitchSim._SnitchSim__sim_active
+    def read(self, addr: int, length: int) -> bytes:
+        if length <= self.data_size:
+            self._submit('read', addr, length)
+            return self.window[:length].tobytes()
+        buf = bytearray(length)
+        self.read_into(addr, buf)
+        return bytes(buf)
+
+    @SnitchSim._SnitchSim__sim_active
+    def read_array(self, addr: int, dtype, count: int):
+        """Read `count` elements of `dtype` into a new numpy array."""
+        import numpy as np
+        arr = np.empty(count, dtype=dtype)
+        self.read_into(addr, arr)
+        return arr
+
+    @SnitchSim._SnitchSim__sim_active
+    def write(self, addr: int, data):
+        """Write any contiguous buffer, including numpy arrays, to memory."""
+        data = memoryview(data).cast('B')
+        for offset, n in self._chunks(len(data)):
+            self.window[:n] = data[offset:offset + n]
+            self._submit('write', addr + offset, n)
+
+    @SnitchSim._SnitchSim__sim_active
+    def poll(self, addr: int, mask32: int, exp32: int):
+        slot = self._submit('poll', addr, (exp32 << 32) | mask32)
+        return self.SLOT.unpack_from(self.shm, slot)[4] & 0xFFFFFFFF
+
+    @SnitchSim._SnitchSim__sim_active
+    def poll_multi(self, polls: list, wait_all: bool = False) -> list:
+        entries = b''.join(struct.pack('=QLL', *p) for p in polls)
+        self.window[:len(entries)] = entries
+        self._submit('poll_all' if wait_all else 'poll_any', len(polls))
+        words = self.window[len(entries):len(entries) + 4 * len(polls)]
+        return list(struct.unpack(f'={len(polls)}L', words))
+
+    @SnitchSim._SnitchSim__sim_active
+    def finish(self, wait_for_sim: bool = True):
+        self._submit('exit', wait=False)
+        if (wait_for_sim):
+            self.sim.wait()
+        else:
+            self.sim.terminate()
+        self.window.release()
+        self.shm.close()
+        self.tmpdir.cleanup()
+        self.sim = None
+
+
 if __name__ == "__main__":
     sim = SnitchSim(*sys.argv[1:])
     sim.start()
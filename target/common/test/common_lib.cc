@@ -2,11 +2,42 @@
 // Solderpad Hardware License, Version 0.51, see LICENSE for details.
 // SPDX-License-Identifier: SHL-0.51
 
+#include <assert.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <string.h>
+#include <svdpi.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <vector>
 
+#include "dram_model.hh"
+#include "hart_trace.hh"
 #include "sim.hh"
+#include "sim_ctrl.hh"
 #include "tb_lib.hh"
 
+/// DPI Functions.
+extern "C" {
+void snitch_trace_open(int hart_id, long long time_scale);
+void snitch_trace_record(int hart_id, int source, long long time,
+                         long long cycle, int priv, int pc, long long insn,
+                         int words, const svBitVecVal *extras);
+void snitch_trace_close(int hart_id);
+int tb_dram_enabled();
+int tb_dram_can_issue(int port, int write);
+void tb_dram_request(int port, long long cycle, int id, long long addr,
+                     int beats, int size, int write);
+int tb_dram_ready(int port, long long cycle, int id, int write);
+void tb_dram_respond(int port, int id, int write);
+void clint_tick(const svOpenArrayHandle msip);
+}
+
 namespace sim {
 
 // Bootloader
@@ -18,9 +49,291 @@ extern const uint8_t tb_bootrom_end;
 // The global memory all memory ports write into.
 GlobalMemory MEM;
 
+// Timing model of the DRAM behind all `tb_memory_axi` ports.
+DramModel DRAM(DRAM_TIMING);
+
+// Recorder for the DPI memory access stream.
+MemTrace *MEM_TRACE = nullptr;
+
+// Traffic counters of the DPI memory accesses.
+MemStats *MEM_STATS = nullptr;
+
+// Control of the clock loop by the IPC host.
+SimControl CTRL;
+
+// Host files mapped into the global memory with `--map`. Writable mappings
+// are shared with the file and synced back to it at exit.
+struct FileMaps {
+    struct FileMap {
+        uint64_t base;
+        size_t size;
+        uint8_t *host;
+        bool rw;
+        std::string path;
+    };
+    std::vector<FileMap> maps;
+
+    ~FileMaps() {
+        for (auto &m : maps) unmap(m);
+    }
+
+    void unmap(FileMap &m) {
+        if (m.rw && msync(m.host, m.size, MS_SYNC) == 0)
+            printf("[Map] Wrote back `%s`\n", m.path.c_str());
+        munmap(m.host, m.size);
+    }
+
+    // Map `<addr>=<file>[:ro|rw]`. Read-only mappings are private, such that
+    // writes of the simulation do not reach the file.
+    bool map(const char *spec) {
+        char *end;
+        uint64_t base = strtoull(spec, &end, 0);
+        if (end == spec || *end != '=') {
+            fprintf(stderr, "[Map] Expected `<addr>=<file>[:ro|rw]`: `%s`\n",
+                    spec);
+            return false;
+        }
+        std::string path = end + 1;
+        bool rw = false;
+        if (path.size() > 3 && (path.compare(path.size() - 3, 3, ":rw") == 0 ||
+                                path.compare(path.size() - 3, 3, ":ro") == 0)) {
+            rw = path.back() == 'w';
+            path.resize(path.size() - 3);
+        }
+        int fd = open(path.c_str(), rw ? O_RDWR : O_RDONLY);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0) {
+            fprintf(stderr, "[Map] Cannot map `%s`\n", path.c_str());
+            if (fd >= 0) close(fd);
+            return false;
+        }
+        size_t size = st.st_size;
+        void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                       rw ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) {
+            perror("[Map] mmap");
+            return false;
+        }
+        // A later simulation of the same process, e.g. in batch mode, maps
+        // the file afresh.
+        for (auto it = maps.begin(); it != maps.end(); ++it) {
+            if (it->base == base) {
+                unmap(*it);
+                MEM.remove_mapping(base);
+                maps.erase(it);
+                break;
+            }
+        }
+        for (const auto &m : MEM.mappings) {
+            if (m.base < base + size && base < m.base + m.size) {
+                fprintf(stderr, "[Map] `%s` overlaps a mapping at 0x%lx\n",
+                        path.c_str(), (unsigned long)m.base);
+                munmap(p, size);
+                return false;
+            }
+        }
+        maps.push_back({base, size, (uint8_t *)p, rw, path});
+        MEM.add_mapping(base, size, (uint8_t *)p);
+        printf("[Map] Mapped `%s` (0x%lx bytes, %s) at 0x%lx\n", path.c_str(),
+               (unsigned long)size, rw ? "rw" : "ro", (unsigned long)base);
+        return true;
+    }
+};
+
+static FileMaps FILE_MAPS;
+
+Sim::~Sim() {
+    // The memory hooks must not outlive the recorders of this simulation.
+    if (MEM_TRACE == mem_trace.get()) MEM_TRACE = nullptr;
+    if (MEM_STATS == mem_stats.get()) MEM_STATS = nullptr;
+}
+
+void Sim::parse_common_args(int argc, char **argv) {
+    static constexpr char MEM_TRACE_FLAG[] = "--mem-trace=";
+    static constexpr char MEM_BACKEND_FLAG[] = "--mem-backend=";
+    static constexpr char MAP_FLAG[] = "--map=";
+    static constexpr char MEM_STATS_FLAG[] = "--mem-stats=";
+    static constexpr char MEM_STATS_WINDOW_FLAG[] = "--mem-stats-window=";
+    const char *mem_stats_path = nullptr;
+    uint64_t mem_stats_window = 10000;
+    for (auto i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--disable_preloading") == 0) {
+            printf("fesvr-based binary preloading disabled\n");
+            disable_preloading = true;
+        }
+        // Back the global memory window with a single sparse `mmap` instead
+        // of on-demand pages: `--mem-backend=mmap` or `mmap-thp`.
+        if (strncmp(argv[i], MEM_BACKEND_FLAG, strlen(MEM_BACKEND_FLAG)) ==
+            0) {
+            const char *backend = argv[i] + strlen(MEM_BACKEND_FLAG);
+            bool thp = strcmp(backend, "mmap-thp") == 0;
+            if (!thp && strcmp(backend, "mmap") != 0) {
+                if (strcmp(backend, "map") != 0)
+                    fprintf(stderr, "Unknown memory backend `%s`\n", backend);
+                continue;
+            }
+            size_t size = BOOTDATA.global_mem_end - BOOTDATA.global_mem_start;
+            if (MEM.reserve(BOOTDATA.global_mem_start, size, thp)) {
+                printf("Global memory backed by mmap at 0x%lx (0x%lx bytes)\n",
+                       BOOTDATA.global_mem_start, size);
+            } else {
+                perror("Failed to reserve global memory, using page map");
+            }
+        }
+        if (strncmp(argv[i], MEM_TRACE_FLAG, strlen(MEM_TRACE_FLAG)) == 0) {
+            const char *path = argv[i] + strlen(MEM_TRACE_FLAG);
+            printf("Recording DPI memory accesses to `%s`\n", path);
+            mem_trace = std::make_unique<MemTrace>(path);
+            MEM_TRACE = mem_trace.get();
+        }
+        // Back `[addr, addr + size of file)` by a host file without copying
+        // it: `--map=<addr>=<file>[:ro|rw]`.
+        if (strncmp(argv[i], MAP_FLAG, strlen(MAP_FLAG)) == 0 &&
+            !FILE_MAPS.map(argv[i] + strlen(MAP_FLAG)))
+            exit(1);
+        if (strncmp(argv[i], MEM_STATS_FLAG, strlen(MEM_STATS_FLAG)) == 0)
+            mem_stats_path = argv[i] + strlen(MEM_STATS_FLAG);
+        if (strncmp(argv[i], MEM_STATS_WINDOW_FLAG,
+                    strlen(MEM_STATS_WINDOW_FLAG)) == 0)
+            mem_stats_window =
+                strtoull(argv[i] + strlen(MEM_STATS_WINDOW_FLAG), 0, 0);
+    }
+    // Count traffic per page and per region of the system.
+    if (mem_stats_path) {
+        printf("Counting DPI memory traffic in windows of %lu cycles to `%s`\n",
+               (unsigned long)mem_stats_window, mem_stats_path);
+        mem_stats =
+            std::make_unique<MemStats>(mem_stats_path, mem_stats_window);
+        size_t bootrom_len = &tb_bootrom_end - &tb_bootrom_start;
+        uint64_t clusters = std::max<uint32_t>(BOOTDATA.cluster_count, 1);
+        uint64_t tcdm_len = BOOTDATA.tcdm_offset
+                                ? BOOTDATA.tcdm_offset * clusters
+                                : BOOTDATA.tcdm_size;
+        mem_stats->add_region("bootrom", BOOTDATA.boot_addr,
+                              BOOTDATA.boot_addr + bootrom_len +
+                                  sizeof(BootData));
+        mem_stats->add_region("tcdm", BOOTDATA.tcdm_start,
+                              BOOTDATA.tcdm_start + tcdm_len);
+        mem_stats->add_region("dram", BOOTDATA.global_mem_start,
+                              BOOTDATA.global_mem_end);
+        MEM_STATS = mem_stats.get();
+    }
+}
+
+// Read the whole ELF file at `path` into `img`.
+static bool read_elf(const std::string &path, std::vector<uint8_t> &img) {
+    FILE *fd = fopen(path.c_str(), "rb");
+    if (!fd) return false;
+    uint8_t buf[1 << 16];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fd)) > 0)
+        img.insert(img.end(), buf, buf + n);
+    fclose(fd);
+    return img.size() >= EI_NIDENT && memcmp(img.data(), ELFMAG, SELFMAG) == 0;
+}
+
+// Write all PT_LOAD segments of an ELF image into memory, zero-filling the
+// part of each segment not backed by the file. Returns the number of bytes
+// written, or zero if the image is not a valid ELF file.
+template <class Ehdr, class Phdr>
+static size_t load_elf_segments(const std::vector<uint8_t> &img,
+                                size_t &nsegs) {
+    if (img.size() < sizeof(Ehdr)) return 0;
+    const Ehdr *eh = reinterpret_cast<const Ehdr *>(img.data());
+    if (eh->e_phoff + (size_t)eh->e_phnum * sizeof(Phdr) > img.size())
+        return 0;
+    const Phdr *ph = reinterpret_cast<const Phdr *>(img.data() + eh->e_phoff);
+    static const std::vector<uint8_t> zeros(GlobalMemory::PAGE_SIZE, 0);
+    size_t bytes = 0;
+    for (int i = 0; i < eh->e_phnum; i++) {
+        if (ph[i].p_type != PT_LOAD || ph[i].p_memsz == 0) continue;
+        if (ph[i].p_offset + ph[i].p_filesz > img.size()) return 0;
+        MEM.write(ph[i].p_paddr, ph[i].p_filesz, &img[ph[i].p_offset],
+                  nullptr);
+        for (size_t off = ph[i].p_filesz; off < ph[i].p_memsz;
+             off += zeros.size()) {
+            size_t n = std::min<size_t>(zeros.size(), ph[i].p_memsz - off);
+            MEM.write(ph[i].p_paddr + off, n, zeros.data(), nullptr);
+        }
+        bytes += ph[i].p_memsz;
+        nsegs++;
+    }
+    return bytes;
+}
+
+// Load the binary straight into `MEM` instead of going through the HTIF
+// memory interface, which splits it into 8-byte chunks. fesvr still parses
+// the ELF for its symbols but skips the preloaded writes.
+bool Sim::preload_elf(const std::string &path) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint8_t> img;
+    if (!read_elf(path, img)) return false;
+    size_t bytes, nsegs = 0;
+    if (img[EI_CLASS] == ELFCLASS32)
+        bytes = load_elf_segments<Elf32_Ehdr, Elf32_Phdr>(img, nsegs);
+    else
+        bytes = load_elf_segments<Elf64_Ehdr, Elf64_Phdr>(img, nsegs);
+    if (!bytes) return false;
+    std::chrono::duration<double, std::milli> t =
+        std::chrono::steady_clock::now() - start;
+    printf("[ELF] Loaded %zu bytes in %zu segments from `%s` in %.3f ms\n",
+           bytes, nsegs, path.c_str(), t.count());
+    return true;
+}
+
+// Search the symbol tables of an ELF image for `name`.
+template <class Ehdr, class Shdr, class Sym>
+static bool find_elf_symbol(const std::vector<uint8_t> &img,
+                            const std::string &name, uint64_t &addr) {
+    if (img.size() < sizeof(Ehdr)) return false;
+    const Ehdr *eh = reinterpret_cast<const Ehdr *>(img.data());
+    if (eh->e_shoff + (size_t)eh->e_shnum * sizeof(Shdr) > img.size())
+        return false;
+    const Shdr *sh = reinterpret_cast<const Shdr *>(img.data() + eh->e_shoff);
+    for (int i = 0; i < eh->e_shnum; i++) {
+        if (sh[i].sh_type != SHT_SYMTAB || sh[i].sh_link >= eh->e_shnum)
+            continue;
+        const Shdr &strtab = sh[sh[i].sh_link];
+        if (sh[i].sh_offset + sh[i].sh_size > img.size() ||
+            strtab.sh_offset + strtab.sh_size > img.size())
+            continue;
+        const Sym *syms =
+            reinterpret_cast<const Sym *>(img.data() + sh[i].sh_offset);
+        const char *strs =
+            reinterpret_cast<const char *>(img.data() + strtab.sh_offset);
+        for (size_t j = 0; j < sh[i].sh_size / sizeof(Sym); j++) {
+            if (syms[j].st_name < strtab.sh_size &&
+                strnlen(strs + syms[j].st_name,
+                        strtab.sh_size - syms[j].st_name) == name.size() &&
+                name == strs + syms[j].st_name) {
+                addr = syms[j].st_value;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool Sim::elf_symbol(const std::string &name, uint64_t &addr) {
+    std::vector<uint8_t> img;
+    if (target_args().empty() || !read_elf(target_args()[0], img))
+        return false;
+    if (img[EI_CLASS] == ELFCLASS32)
+        return find_elf_symbol<Elf32_Ehdr, Elf32_Shdr, Elf32_Sym>(img, name,
+                                                                  addr);
+    return find_elf_symbol<Elf64_Ehdr, Elf64_Shdr, Elf64_Sym>(img, name, addr);
+}
+
 // Override HTIF to populate bootloader with system specification and entry
 // symbol.
 void Sim::start() {
+    // The DUT is in reset, so no transaction is in flight. Drop the state of
+    // a previous binary in batch mode.
+    DRAM.reset();
+    // Load the binary natively unless it is preloaded through a sideband.
+    if (!disable_preloading && !target_args().empty())
+        elf_preloaded = preload_elf(target_args()[0]);
     htif_t::start();
 
     // Write the bootloader into memory.
@@ -43,8 +356,9 @@ void Sim::start() {
     size_t bdp = BOOTDATA.boot_addr + bllen;
     MEM.write(bdp, bdlen, reinterpret_cast<const uint8_t *>(&BOOTDATA),
               nullptr);
-    std::cout << "[fesvr] Wrote " << bdlen << " bytes of bootdata to 0x"
-              << std::hex << bdp << "\n";
+    std::cout << "[fesvr] Wrote " << std::dec << bdlen
+              << " bytes of bootdata to 0x" << std::hex << bdp << std::dec
+              << "\n";
 }
 
 void Sim::read_chunk(addr_t taddr, size_t len, void *dst) {
@@ -52,8 +366,82 @@ void Sim::read_chunk(addr_t taddr, size_t len, void *dst) {
 }
 
 void Sim::write_chunk(addr_t taddr, size_t len, const void *src) {
+    htif_active = true;
     uint8_t strb[8] = {1, 1, 1, 1, 1, 1, 1, 1};
     MEM.write(taddr, len, reinterpret_cast<const uint8_t *>(src), strb);
 }
 
 }  // namespace sim
+
+// Binary instruction traces of the tracer in `snitch_cc.sv`, by hart ID.
+static std::vector<std::unique_ptr<sim::HartTrace>> HART_TRACES;
+
+void snitch_trace_open(int hart_id, long long time_scale) {
+    char path[64];
+    snprintf(path, sizeof(path), "logs/trace_hart_%05x.bin", hart_id);
+    if (HART_TRACES.size() <= (size_t)hart_id)
+        HART_TRACES.resize(hart_id + 1);
+    HART_TRACES[hart_id] =
+        std::make_unique<sim::HartTrace>(path, hart_id, time_scale);
+    printf("[Tracer] Logging Hart %d to %s\n", hart_id, path);
+}
+
+void snitch_trace_record(int hart_id, int source, long long time,
+                         long long cycle, int priv, int pc, long long insn,
+                         int words, const svBitVecVal *extras) {
+    if (sim::CTRL.has_pc_breaks && source == sim::HartTrace::SrcSnitch)
+        sim::CTRL.check_pc(pc);
+    HART_TRACES[hart_id]->record(source, time, cycle, priv, pc, insn, words,
+                                 extras);
+}
+
+void snitch_trace_close(int hart_id) { HART_TRACES[hart_id].reset(); }
+
+int tb_dram_enabled() {
+    static bool reported = false;
+    if (!sim::DRAM.enabled()) return 0;
+    if (reported) return 1;
+    reported = true;
+    const auto &t = sim::DRAM.timing;
+    printf(
+        "[DRAM] Latency %u (+%u on row miss), %.2f B/cycle, %u banks of "
+        "%u B rows, %u outstanding\n",
+        t.latency, t.row_miss_latency, t.bytes_per_cycle, t.banks, t.row_size,
+        t.max_outstanding);
+    return 1;
+}
+
+int tb_dram_can_issue(int port, int write) {
+    return sim::DRAM.can_issue(port, write);
+}
+
+void tb_dram_request(int port, long long cycle, int id, long long addr,
+                     int beats, int size, int write) {
+    sim::DRAM.request(port, cycle, id, addr, beats, size, write);
+}
+
+int tb_dram_ready(int port, long long cycle, int id, int write) {
+    return sim::DRAM.ready(port, cycle, id, write);
+}
+
+void tb_dram_respond(int port, int id, int write) {
+    sim::DRAM.respond(port, id, write);
+}
+
+// Cores read their msip bits from the CLINT every cycle. The words are cached
+// as a device of the global memory and only expanded into bits after a write.
+void clint_tick(const svOpenArrayHandle msip) {
+    static const size_t num_cores = sim::BOOTDATA.core_count;
+    static auto &clint =
+        sim::MEM.add_device(sim::BOOTDATA.clint_base, (num_cores + 31) / 32);
+    static std::vector<uint8_t> bits(num_cores);
+    static uint64_t version = ~(uint64_t)0;
+    uint8_t *msip_ptr = (uint8_t *)svGetArrayPtr(msip);
+    assert(msip_ptr);
+    if (clint.version != version) {
+        version = clint.version;
+        for (size_t i = 0; i < num_cores; i++)
+            bits[i] = (clint.regs[i / 32] >> (i % 32)) & 1;
+    }
+    memcpy(msip_ptr, bits.data(), num_cores);
+}
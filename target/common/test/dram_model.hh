@@ -0,0 +1,187 @@
+// Copyright 2024 KU Leuven.
+// Solderpad Hardware License, Version 0.51, see LICENSE for details.
+// SPDX-License-Identifier: SHL-0.51
+
+#pragma once
+#include <stdint.h>
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace sim {
+
+// Timing parameters of the DRAM, from the `dram.timing` block of the cluster
+// configuration. All zero disables the model.
+struct DramTiming {
+    // Cycles from a request to its first data on a row buffer hit.
+    uint32_t latency;
+    // Additional cycles to open a row on a row buffer miss.
+    uint32_t row_miss_latency;
+    // Peak bandwidth shared by all ports, zero for unlimited.
+    double bytes_per_cycle;
+    // Number of banks and bytes per row of each bank.
+    uint32_t banks;
+    uint32_t row_size;
+    // Outstanding transactions per port and direction, zero for unlimited.
+    uint32_t max_outstanding;
+};
+extern const DramTiming DRAM_TIMING;
+
+// Timing model of the DRAM behind the testbench memory ports. The functional
+// memory still answers every access immediately; `tb_memory_axi` merely holds
+// back R beats and B responses until the model releases them. Addresses are
+// interleaved across banks at row granularity, each bank keeps one row open,
+// and all ports share the data bus.
+struct DramModel {
+    struct Txn {
+        uint32_t beats;  // beats left to respond
+        double next;     // cycle the next beat is ready
+        double interval;
+    };
+
+    // In-flight transactions by port, direction and AXI ID, in issue order.
+    struct Port {
+        std::map<uint32_t, std::deque<Txn>> txns[2];
+        uint32_t outstanding[2] = {0, 0};
+    };
+
+    DramTiming timing;
+    std::vector<Port> ports;
+    std::vector<uint64_t> open_row;
+    double bus_free = 0;
+
+    explicit DramModel(const DramTiming &t) : timing(t) {
+        timing.banks = std::max<uint32_t>(timing.banks, 1);
+        timing.row_size = std::max<uint32_t>(timing.row_size, 1);
+        open_row.assign(timing.banks, ~(uint64_t)0);
+    }
+
+    // Forget all transactions and open rows.
+    void reset() {
+        ports.clear();
+        open_row.assign(timing.banks, ~(uint64_t)0);
+        bus_free = 0;
+    }
+
+    bool enabled() const {
+        return timing.latency || timing.row_miss_latency ||
+               timing.bytes_per_cycle > 0 || timing.max_outstanding;
+    }
+
+    Port &port(uint32_t p) {
+        if (ports.size() <= p) ports.resize(p + 1);
+        return ports[p];
+    }
+
+    // Whether `port` may issue another request in direction `write`.
+    bool can_issue(uint32_t p, bool write) {
+        return !timing.max_outstanding ||
+               port(p).outstanding[write] < timing.max_outstanding;
+    }
+
+    // Account a request of `beats` beats of `size` bytes issued at `cycle`.
+    void request(uint32_t p, uint64_t cycle, uint32_t id, uint64_t addr,
+                 uint32_t beats, uint32_t size, bool write) {
+        uint64_t row = addr / timing.row_size;
+        uint32_t bank = row % timing.banks;
+        double start = cycle + timing.latency;
+        if (open_row[bank] != row) {
+            start += timing.row_miss_latency;
+            open_row[bank] = row;
+        }
+        double interval =
+            timing.bytes_per_cycle > 0 ? size / timing.bytes_per_cycle : 0;
+        start = std::max(start, bus_free);
+        bus_free = start + beats * interval;
+        // Writes are acknowledged once all their data is transferred.
+        Txn t = write ? Txn{1, bus_free, 0}
+                      : Txn{beats, start + interval, interval};
+        auto &q = port(p);
+        q.txns[write][id].push_back(t);
+        q.outstanding[write]++;
+    }
+
+    // Whether the next response beat for `id` may be handed out at `cycle`.
+    bool ready(uint32_t p, uint64_t cycle, uint32_t id, bool write) {
+        auto &txns = port(p).txns[write];
+        auto it = txns.find(id);
+        // Responses the model has not seen a request for, e.g. from atomics,
+        // pass unhindered.
+        if (it == txns.end() || it->second.empty()) return true;
+        return it->second.front().next <= cycle;
+    }
+
+    // Retire one response beat for `id`.
+    void respond(uint32_t p, uint32_t id, bool write) {
+        auto &q = port(p);
+        auto it = q.txns[write].find(id);
+        if (it == q.txns[write].end() || it->second.empty()) return;
+        Txn &t = it->second.front();
+        t.next += t.interval;
+        if (--t.beats == 0) {
+            it->second.pop_front();
+            q.outstanding[write]--;
+        }
+    }
+
+    // Write the open rows, the bus and the in-flight transactions to `os`
+    // with its raw `write`, e.g. a `VerilatedSave` for checkpoints. The timing
+    // is part of the configuration and not saved.
+    template <class Stream>
+    void save(Stream &os) const {
+        auto put = [&](const auto &v) { os.write(&v, sizeof(v)); };
+        put((uint64_t)open_row.size());
+        for (uint64_t row : open_row) put(row);
+        put(bus_free);
+        put((uint64_t)ports.size());
+        for (const Port &p : ports) {
+            for (int w = 0; w < 2; w++) {
+                put(p.outstanding[w]);
+                put((uint64_t)p.txns[w].size());
+                for (const auto &id : p.txns[w]) {
+                    put(id.first);
+                    put((uint64_t)id.second.size());
+                    for (const Txn &t : id.second) put(t);
+                }
+            }
+        }
+    }
+
+    // Read the state written by `save` from `is`. Fails if it was saved with
+    // a different number of banks.
+    template <class Stream>
+    bool restore(Stream &is) {
+        auto get = [&](auto &v) { is.read(&v, sizeof(v)); };
+        uint64_t banks, num_ports;
+        get(banks);
+        if (banks != open_row.size()) return false;
+        for (uint64_t &row : open_row) get(row);
+        get(bus_free);
+        get(num_ports);
+        ports.assign(num_ports, Port());
+        for (Port &p : ports) {
+            for (int w = 0; w < 2; w++) {
+                uint64_t ids;
+                get(p.outstanding[w]);
+                get(ids);
+                for (uint64_t i = 0; i < ids; i++) {
+                    uint32_t id;
+                    uint64_t num;
+                    get(id);
+                    get(num);
+                    auto &q = p.txns[w][id];
+                    q.resize(num);
+                    for (Txn &t : q) get(t);
+                }
+            }
+        }
+        return true;
+    }
+};
+
+// Timing model of the DRAM behind all `tb_memory_axi` ports.
+extern DramModel DRAM;
+
+}  // namespace sim
@@ -0,0 +1,87 @@
+// Copyright 2024 KU Leuven.
+// Solderpad Hardware License, Version 0.51, see LICENSE for details.
+// SPDX-License-Identifier: SHL-0.51
+
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+
+namespace sim {
+
+// Binary per-hart instruction trace, written by the tracer in `snitch_cc.sv`
+// through DPI when built with `SNITCH_TRACE_BINARY`, instead of formatting
+// text in the RTL. `trace_decode` turns it back into the `.dasm` format.
+//
+// A file starts with a `Header`, followed by one `Record` per traced event.
+// Each record is followed by the nonzero 64-bit fields of the trace port
+// struct of its source, in declaration order; bit `i` of `mask` is set if
+// field `i` is stored.
+struct HartTrace {
+    static constexpr uint64_t MAGIC = 0x3145434152544e53;  // "SNTRACE1"
+
+    // Mirrors `snitch_pkg::trace_src_e`.
+    enum Source : uint8_t {
+        SrcSnitch = 0,
+        SrcFpu = 1,
+        SrcFpuSeq = 2,
+    };
+
+    struct Header {
+        uint64_t magic;
+        uint32_t hart_id;
+        uint32_t reserved;
+        // Simulation time printed by `%t` per `$time` unit of the tracer.
+        uint64_t time_scale;
+    };
+
+    struct Record {
+        uint64_t time;
+        uint64_t cycle;
+        uint64_t insn;
+        uint64_t mask;
+        uint32_t pc;
+        uint8_t priv;
+        uint8_t source;
+        uint16_t reserved;
+    };
+
+    FILE *fd = nullptr;
+
+    HartTrace(const char *path, uint32_t hart_id, uint64_t time_scale) {
+        fd = fopen(path, "wb");
+        if (!fd) {
+            fprintf(stderr, "[HartTrace] Cannot open `%s`\n", path);
+            return;
+        }
+        setvbuf(fd, nullptr, _IOFBF, 1 << 20);
+        Header h = {MAGIC, hart_id, 0, time_scale};
+        fwrite(&h, sizeof(h), 1, fd);
+    }
+
+    ~HartTrace() {
+        if (fd) fclose(fd);
+    }
+
+    // Append an event. `extras` holds the packed trace port struct of
+    // `words` 64-bit fields as DPI bit vector, first field most significant.
+    void record(uint8_t source, uint64_t time, uint64_t cycle, uint8_t priv,
+                uint32_t pc, uint64_t insn, int words,
+                const uint32_t *extras) {
+        if (!fd) return;
+        Record r = {time, cycle, insn, 0, pc, priv, source, 0};
+        uint64_t fields[64];
+        int n = 0;
+        for (int i = 0; i < words && i < 64; i++) {
+            const uint32_t *w = extras + 2 * (words - 1 - i);
+            uint64_t v = (uint64_t)w[1] << 32 | w[0];
+            if (v) {
+                r.mask |= (uint64_t)1 << i;
+                fields[n++] = v;
+            }
+        }
+        fwrite(&r, sizeof(r), 1, fd);
+        fwrite(fields, sizeof(uint64_t), n, fd);
+    }
+};
+
+}  // namespace sim
@@ -5,17 +5,90 @@
 // Paul Scheffler <paulsc@iis.ee.ethz.ch>
 
 #include "ipc.hh"
+
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "sim_ctrl.hh"
 #include "tb_lib.hh"
 
+// Poll 32b words until any (or all) differ from their expected value under
+// the mask packed into `len`, and return the last words read. Instead of
+// sleeping for a fixed period, the IPC thread blocks until the simulation
+// writes to one of the polled words.
+void IpcIface::poll_multi(const ipc_poll_t* polls, uint64_t count, bool all,
+                          uint32_t* words) {
+    for (uint64_t i = 0; i < count; i++)
+        sim::MEM.watch(polls[i].addr, sizeof(uint32_t));
+    while (1) {
+        uint64_t gen = sim::MEM.watch_generation();
+        uint64_t hits = 0;
+        for (uint64_t i = 0; i < count; i++) {
+            // Unpack 32b checking mask and expected value from length
+            uint32_t mask = polls[i].len & 0xFFFFFFFF;
+            uint32_t expected = (polls[i].len >> 32) & 0xFFFFFFFF;
+            sim::MEM.read(polls[i].addr, sizeof(uint32_t),
+                          (uint8_t*)(void*)&words[i]);
+            if ((words[i] & mask) != (expected & mask)) hits++;
+        }
+        if (all ? hits == count : hits > 0) break;
+        sim::MEM.wait_for_write(
+            gen, std::chrono::microseconds(IPC_POLL_TIMEOUT_US));
+    }
+    for (uint64_t i = 0; i < count; i++)
+        sim::MEM.unwatch(polls[i].addr, sizeof(uint32_t));
+}
+
+uint32_t IpcIface::poll(uint64_t addr, uint64_t len) {
+    ipc_poll_t p = {addr, len};
+    uint32_t read;
+    poll_multi(&p, 1, false, &read);
+    return read;
+}
+
+// Handle a control operation of the clock loop and fill the two reply words.
+// Returns whether the operation sends a reply.
+bool IpcIface::control(uint64_t opcode, uint64_t addr, uint64_t len,
+                       const char* path, uint64_t* reply) {
+    switch (opcode) {
+        case Pause:
+            reply[0] = sim::CTRL.pause(reply[1]);
+            return true;
+        case Resume:
+            sim::CTRL.resume();
+            return false;
+        case Run:
+            reply[0] = sim::CTRL.run(addr, reply[1]);
+            return true;
+        case BreakPc:
+            reply[0] = sim::CTRL.break_pc(addr, len != 0, reply[1]);
+            return true;
+        case BreakWrite:
+            sim::CTRL.break_write(addr, len);
+            return false;
+        case Time:
+            reply[1] = sim::CTRL.time();
+            reply[0] = reply[1] / 2;
+            return true;
+        case Checkpoint:
+            reply[1] = sim::CTRL.save_checkpoint(std::string(path, len));
+            reply[0] = sim::CTRL.time() / 2;
+            return true;
+    }
+    return false;
+}
+
 void* IpcIface::ipc_thread_handle(void* in) {
     ipc_targs_t* targs = (ipc_targs_t*)in;
     // Open FIFOs
     FILE* tx = fopen(targs->tx, "rb");
     FILE* rx = fopen(targs->rx, "wb");
-    // Prepare data and full-strobe array
+    // Prepare data buffer. Strobes are byte-granular in `GlobalMemory`, so
+    // full writes pass no strobe at all.
     uint8_t buf_data[IPC_BUF_SIZE];
-    uint8_t buf_strb[IPC_BUF_SIZE_STRB];
-    std::fill_n(buf_strb, IPC_BUF_SIZE_STRB, 0xFF);
     // Handle commands
     ipc_op_t op;
 
@@ -51,31 +124,48 @@ void* IpcIface::ipc_thread_handle(void* in) {
                          i -= IPC_BUF_SIZE) {
                         fread(buf_data, IPC_BUF_SIZE, 1, tx);
                         sim::MEM.write(op.addr, IPC_BUF_SIZE, buf_data,
-                                       buf_strb);
+                                       nullptr);
                         op.addr += IPC_BUF_SIZE;
                         op.len -= IPC_BUF_SIZE;
                     }
                     fread(buf_data, op.len, 1, tx);
-                    sim::MEM.write(op.addr, op.len, buf_data, buf_strb);
+                    sim::MEM.write(op.addr, op.len, buf_data, nullptr);
                     break;
-                case Poll:
-                    // Unpack 32b checking mask and expected value from length
-                    uint32_t mask = op.len & 0xFFFFFFFF;
-                    uint32_t expected = (op.len >> 32) & 0xFFFFFFFF;
+                case Poll: {
                     printf("[IPC] Poll on 0x%x mask 0x%x expected 0x%x ...\n",
-                           op.addr, mask, expected);
-                    uint32_t read;
-                    do {
-                        sim::MEM.read(op.addr, sizeof(uint32_t),
-                                      (uint8_t*)(void*)&read);
-                        nanosleep(
-                            (const struct timespec[]){{0, IPC_POLL_PERIOD_NS}},
-                            NULL);
-                    } while ((read & mask) == (expected & mask));
+                           op.addr, (uint32_t)op.len,
+                           (uint32_t)(op.len >> 32));
+                    uint32_t read = poll(op.addr, op.len);
                     // Send back read 32b word
                     fwrite(&read, sizeof(uint32_t), 1, rx);
                     fflush(rx);
                     break;
+                }
+                case PollAny:
+                case PollAll: {
+                    // Number of polls is passed in the address field
+                    uint64_t count = std::min<uint64_t>(op.addr, IPC_MAX_POLLS);
+                    ipc_poll_t polls[IPC_MAX_POLLS];
+                    uint32_t words[IPC_MAX_POLLS];
+                    printf("[IPC] Poll on %d words ...\n", (int)count);
+                    fread(polls, sizeof(ipc_poll_t), count, tx);
+                    poll_multi(polls, count, op.opcode == PollAll, words);
+                    fwrite(words, sizeof(uint32_t), count, rx);
+                    fflush(rx);
+                    break;
+                }
+                default: {
+                    // Checkpoint paths follow the operation
+                    uint64_t reply[2];
+                    char path[IPC_BUF_SIZE];
+                    uint64_t len = std::min<uint64_t>(op.len, IPC_BUF_SIZE);
+                    if (op.opcode == Checkpoint) fread(path, len, 1, tx);
+                    if (control(op.opcode, op.addr, len, path, reply)) {
+                        fwrite(reply, sizeof(reply), 1, rx);
+                        fflush(rx);
+                    }
+                    break;
+                }
             }
         }
     }
@@ -86,32 +176,178 @@ void* IpcIface::ipc_thread_handle(void* in) {
     pthread_exit(NULL);
 }
 
+// Whether `[offset, offset + len)` lies within `size` bytes, without overflow.
+static bool within(uint64_t offset, uint64_t len, uint64_t size) {
+    return offset <= size && len <= size - offset;
+}
+
+// Check that a slot only touches the data window, which has `window` bytes.
+bool IpcIface::shm_slot_valid(const ipc_shm_slot_t* op, uint64_t window) {
+    switch (op->opcode) {
+        case Read:
+        case Write:
+        case Checkpoint:
+            return within(op->offset, op->len, window);
+        case PollAny:
+        case PollAll:
+            return op->addr <= IPC_MAX_POLLS &&
+                   within(op->offset,
+                          op->addr * (sizeof(ipc_poll_t) + sizeof(uint32_t)),
+                          window);
+        default:
+            return true;
+    }
+}
+
+void* IpcIface::ipc_shm_thread_handle(void* in) {
+    ipc_targs_t* targs = (ipc_targs_t*)in;
+    // Map the region set up by the host
+    int fd = open(targs->shm, O_RDWR);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        fprintf(stderr, "[IPC] Cannot open shared memory `%s`\n", targs->shm);
+        exit(IPC_ERR_SHM);
+    }
+    uint64_t size = st.st_size;
+    uint8_t* region =
+        size < sizeof(ipc_shm_hdr_t)
+            ? (uint8_t*)MAP_FAILED
+            : (uint8_t*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                             fd, 0);
+    close(fd);
+    ipc_shm_hdr_t* hdr = (ipc_shm_hdr_t*)region;
+    // The host owns the region, so take the layout once and check that the
+    // ring and the data window lie within it
+    uint64_t ring_size = 0, data_offset = 0, window = 0;
+    if (region != MAP_FAILED) {
+        ring_size = hdr->ring_size;
+        data_offset = hdr->data_offset;
+        window = std::min(hdr->data_size, size - std::min(data_offset, size));
+    }
+    if (region == MAP_FAILED || hdr->magic != IPC_SHM_MAGIC ||
+        ring_size == 0 || (ring_size & (ring_size - 1)) != 0 ||
+        data_offset > size || data_offset < sizeof(ipc_shm_hdr_t) ||
+        ring_size > (data_offset - sizeof(ipc_shm_hdr_t)) /
+                        sizeof(ipc_shm_slot_t)) {
+        fprintf(stderr, "[IPC] Invalid shared memory region `%s`\n",
+                targs->shm);
+        exit(IPC_ERR_SHM);
+    }
+    ipc_shm_slot_t* ring = (ipc_shm_slot_t*)(hdr + 1);
+    uint8_t* data = region + data_offset;
+
+    // Handle commands until the host requests to exit
+    uint64_t tail = hdr->tail;
+    bool done = false;
+    int idle = 0;
+    while (!done) {
+        uint64_t head = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            // Yield for back-to-back commands, then back off
+            if (++idle > IPC_SHM_IDLE_SPINS)
+                nanosleep((const struct timespec[]){{0, IPC_SHM_IDLE_NS}},
+                          NULL);
+            else
+                sched_yield();
+            continue;
+        }
+        idle = 0;
+        for (; tail != head; tail++) {
+            // Work on a copy, so the host cannot change a checked slot
+            ipc_shm_slot_t* slot = &ring[tail & (ring_size - 1)];
+            ipc_shm_slot_t cmd = *slot;
+            const ipc_shm_slot_t* op = &cmd;
+            slot->error = !shm_slot_valid(op, window);
+            if (slot->error) {
+                fprintf(stderr,
+                        "[IPC] Rejected operation %lu outside the data "
+                        "window\n",
+                        (unsigned long)op->opcode);
+                __atomic_store_n(&hdr->tail, tail + 1, __ATOMIC_RELEASE);
+                continue;
+            }
+            switch (op->opcode) {
+                case Read:
+                    sim::MEM.read(op->addr, op->len, data + op->offset);
+                    break;
+                case Write:
+                    sim::MEM.write(op->addr, op->len, data + op->offset,
+                                   nullptr);
+                    break;
+                case Poll:
+                    slot->result = poll(op->addr, op->len);
+                    break;
+                case PollAny:
+                case PollAll: {
+                    // Entries are in the window, followed by the result words
+                    ipc_poll_t polls[IPC_MAX_POLLS];
+                    uint32_t words[IPC_MAX_POLLS];
+                    uint64_t count = op->addr;
+                    memcpy(polls, data + op->offset,
+                           count * sizeof(ipc_poll_t));
+                    poll_multi(polls, count, op->opcode == PollAll, words);
+                    memcpy(data + op->offset + count * sizeof(ipc_poll_t),
+                           words, count * sizeof(uint32_t));
+                    break;
+                }
+                case Exit:
+                    done = true;
+                    break;
+                default: {
+                    uint64_t reply[2];
+                    if (control(op->opcode, op->addr, op->len,
+                                (const char*)data + op->offset, reply)) {
+                        slot->result = reply[0];
+                        slot->status = reply[1];
+                    }
+                    break;
+                }
+            }
+            __atomic_store_n(&hdr->tail, tail + 1, __ATOMIC_RELEASE);
+        }
+    }
+
+    printf("[IPC] Shared memory closed by host. Joining main thread.\n");
+    munmap(region, size);
+    pthread_exit(NULL);
+}
+
 // Conditionally construct IPC iff any arguments specify it
 IpcIface::IpcIface(int argc, char** argv) {
-    static constexpr char IPC_FLAG[6] = "--ipc";
+    static constexpr char IPC_FLAG[7] = "--ipc,";
+    static constexpr char IPC_SHM_FLAG[11] = "--ipc-shm,";
     active = false;
+    targs = {NULL, NULL, NULL};
     for (auto i = 1; i < argc; ++i) {
-        if (strncmp(argv[i], IPC_FLAG, strlen(IPC_FLAG)) == 0) {
-            // Check for duplicate args
-            if (active) {
-                fprintf(stderr, "[IPC] Duplicate IPC thread args: %s", argv[i]);
-                exit(IPC_ERR_DOUBLE_ARG);
-            }
+        bool fifo = strncmp(argv[i], IPC_FLAG, strlen(IPC_FLAG)) == 0;
+        bool shm = strncmp(argv[i], IPC_SHM_FLAG, strlen(IPC_SHM_FLAG)) == 0;
+        if (!fifo && !shm) continue;
+        // Check for duplicate args
+        if (active) {
+            fprintf(stderr, "[IPC] Duplicate IPC thread args: %s", argv[i]);
+            exit(IPC_ERR_DOUBLE_ARG);
+        }
+        if (shm) {
+            // Store shared memory path persistently
+            targs.shm = strdup(argv[i] + strlen(IPC_SHM_FLAG));
+            pthread_create(&thread, NULL, *ipc_shm_thread_handle,
+                           (void*)&targs);
+            printf("[IPC] Thread launched with shared memory `%s`\n",
+                   targs.shm);
+        } else {
             // Parse IPC thread arguments
-            char* ipc_args = argv[i] + strlen(IPC_FLAG) + 1;
+            char* ipc_args = argv[i] + strlen(IPC_FLAG);
             char* tx = strtok(ipc_args, ",");
             char* rx = strtok(NULL, ",");
             // Store arguments persistently
-            targs.tx = (char*)malloc(strlen(tx));
-            targs.rx = (char*)malloc(strlen(rx));
-            strcpy(targs.tx, tx);
-            strcpy(targs.rx, rx);
+            targs.tx = strdup(tx);
+            targs.rx = strdup(rx);
             // Initialize IO thread which will handle TX, RX pipes
             pthread_create(&thread, NULL, *ipc_thread_handle, (void*)&targs);
             printf("[IPC] Thread launched with TX FIFO `%s`, RX FIFO `%s`\n",
                    targs.tx, targs.rx);
-            active = true;
         }
+        active = true;
     }
 }
 
@@ -123,5 +359,6 @@ IpcIface::~IpcIface() {
         active = false;
         free(targs.tx);
         free(targs.rx);
+        free(targs.shm);
     }
 }
@@ -18,15 +18,38 @@
 class IpcIface {
    private:
     static const int IPC_BUF_SIZE = 4096;
-    static const int IPC_BUF_SIZE_STRB = IPC_BUF_SIZE / 8 + 1;
     static const int IPC_ERR_DOUBLE_ARG = 30;
-    static const long IPC_POLL_PERIOD_NS = 100000L;
+    static const int IPC_MAX_POLLS = IPC_BUF_SIZE / 16;
+    // Polls block on memory watchpoints; this only bounds the wait for
+    // updates that bypass `GlobalMemory::write`.
+    static const long IPC_POLL_TIMEOUT_US = 10000L;
+
+    static const uint64_t IPC_SHM_MAGIC = 0x4350494d48534e53ULL;  // SNSHMIPC
+    static const long IPC_SHM_IDLE_NS = 10000L;
+    static const int IPC_SHM_IDLE_SPINS = 4096;
+    static const int IPC_ERR_SHM = 31;
 
     // Possible IPC operations
     enum ipc_opcode_e {
         Read = 0,
         Write = 1,
         Poll = 2,
+        // Shared-memory transport only: the FIFO transport exits on EOF
+        Exit = 3,
+        // Batched polls on `addr` words, until any or all of them change
+        PollAny = 4,
+        PollAll = 5,
+        // Control of the clock loop, see `sim_ctrl.hh`. Pause, Run, BreakPc,
+        // Time and Checkpoint reply with the cycle and a second word: the
+        // stop reason, `Unsupported` if PC breakpoints are not checked, the
+        // simulation time or whether the checkpoint was saved
+        Pause = 6,
+        Resume = 7,
+        Run = 8,          // for `addr` cycles, or until a breakpoint if zero
+        BreakPc = 9,      // set at PC `addr` if `len` is nonzero, else clear
+        BreakWrite = 10,  // on `addr` for `len` bytes, clear if `len` is zero
+        Time = 11,
+        Checkpoint = 12,  // to the path of `len` bytes following the operation
     };
 
     // Operations are 3 doubles, followed by data streams in either direction
@@ -36,10 +59,44 @@ class IpcIface {
         uint64_t len;
     } ipc_op_t;
 
+    // Batched polls send `addr` of these entries after the operation and
+    // receive one 32b word per entry back
+    typedef struct {
+        uint64_t addr;
+        uint64_t len;  // 32b mask and expected value as for `Poll`
+    } ipc_poll_t;
+
+    // Shared-memory transport: a header, a single-producer single-consumer
+    // command ring written by the host and a bulk data window. The host
+    // publishes slots by advancing `head`, the simulator retires them by
+    // advancing `tail`. Data of reads and writes lives in the window at the
+    // slot's `offset`, so each transfer is a single copy into `sim::MEM`.
+    typedef struct {
+        uint64_t magic;
+        uint64_t ring_size;    // number of slots, power of two
+        uint64_t data_offset;  // offset of the data window in the region
+        uint64_t data_size;
+        uint64_t head;
+        uint64_t tail;
+        uint64_t reserved[2];
+    } ipc_shm_hdr_t;
+
+    typedef struct {
+        uint64_t opcode;
+        uint64_t addr;
+        uint64_t len;
+        uint64_t offset;  // into the data window
+        uint64_t result;  // polled word or cycle of control operations
+        uint64_t status;  // second reply word of control operations
+        uint64_t error;   // nonzero if the operation was rejected
+        uint64_t reserved;
+    } ipc_shm_slot_t;
+
     // Args passed to IPC thread
     typedef struct {
         char* tx;
         char* rx;
+        char* shm;
     } ipc_targs_t;
 
     // Thread to asynchronously handle FIFOs
@@ -48,6 +105,13 @@ class IpcIface {
     bool active;
 
     static void* ipc_thread_handle(void* in);
+    static void* ipc_shm_thread_handle(void* in);
+    static bool shm_slot_valid(const ipc_shm_slot_t* op, uint64_t window);
+    static uint32_t poll(uint64_t addr, uint64_t len);
+    static void poll_multi(const ipc_poll_t* polls, uint64_t count, bool all,
+                           uint32_t* words);
+    static bool control(uint64_t opcode, uint64_t addr, uint64_t len,
+                        const char* path, uint64_t* reply);
 
    public:
     IpcIface(int argc, char** argv);
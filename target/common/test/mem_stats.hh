@@ -0,0 +1,210 @@
+// Copyright 2024 KU Leuven.
+// Solderpad Hardware License, Version 0.51, see LICENSE for details.
+// SPDX-License-Identifier: SHL-0.51
+
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sim {
+
+// Traffic counters of the DPI memory accesses, per page and per region of the
+// address space, sampled in windows of simulated cycles. Written as CSV, or as
+// JSON if the file name ends in `.json`, once the simulation ends.
+struct MemStats {
+    static constexpr size_t ADDR_SHIFT = 12;
+
+    struct Counters {
+        uint64_t reads = 0;
+        uint64_t writes = 0;
+        uint64_t read_bytes = 0;
+        uint64_t write_bytes = 0;
+
+        void add(uint32_t len, bool write) {
+            if (write) {
+                writes++;
+                write_bytes += len;
+            } else {
+                reads++;
+                read_bytes += len;
+            }
+        }
+    };
+
+    struct Region {
+        std::string name;
+        uint64_t start, end;
+    };
+
+    // One window of `window_cycles` cycles, by page index and by region. The
+    // last region counts accesses outside all others.
+    struct Window {
+        std::map<uint64_t, Counters> pages;
+        std::vector<Counters> regions;
+    };
+
+    std::string path;
+    uint64_t window_cycles;
+    std::vector<Region> regions;
+    std::map<uint64_t, Window> windows;
+
+    MemStats(const std::string &path, uint64_t window_cycles)
+        : path(path), window_cycles(std::max<uint64_t>(window_cycles, 1)) {}
+
+    ~MemStats() { dump(); }
+
+    // Regions must not overlap; the first match wins.
+    void add_region(const std::string &name, uint64_t start, uint64_t end) {
+        regions.push_back({name, start, end});
+    }
+
+    void read(uint64_t cycle, uint64_t addr, uint32_t len) {
+        account(cycle, addr, len, false);
+    }
+
+    void write(uint64_t cycle, uint64_t addr, uint32_t len) {
+        account(cycle, addr, len, true);
+    }
+
+    void dump() {
+        if (path.empty()) return;
+        FILE *fd = fopen(path.c_str(), "w");
+        if (!fd) {
+            fprintf(stderr, "[MemStats] Cannot open `%s`\n", path.c_str());
+            return;
+        }
+        bool json = path.size() >= 5 &&
+                    path.compare(path.size() - 5, 5, ".json") == 0;
+        if (json)
+            dump_json(fd);
+        else
+            dump_csv(fd);
+        fclose(fd);
+        summarize();
+        path.clear();
+    }
+
+   private:
+    // Most accesses fall into the same window and page as the previous one.
+    uint64_t last_window = ~(uint64_t)0, last_idx = ~(uint64_t)0;
+    Window *last = nullptr;
+    Counters *last_page = nullptr;
+
+    size_t region(uint64_t addr) const {
+        for (size_t i = 0; i < regions.size(); i++)
+            if (addr >= regions[i].start && addr < regions[i].end) return i;
+        return regions.size();
+    }
+
+    const char *region_name(size_t i) const {
+        return i < regions.size() ? regions[i].name.c_str() : "other";
+    }
+
+    void account(uint64_t cycle, uint64_t addr, uint32_t len, bool write) {
+        uint64_t w = cycle / window_cycles, idx = addr >> ADDR_SHIFT;
+        if (w != last_window) {
+            last = &windows[w];
+            last->regions.resize(regions.size() + 1);
+            last_window = w;
+            last_idx = ~(uint64_t)0;
+        }
+        if (idx != last_idx) {
+            last_page = &last->pages[idx];
+            last_idx = idx;
+        }
+        last_page->add(len, write);
+        last->regions[region(addr)].add(len, write);
+    }
+
+    void dump_csv(FILE *fd) const {
+        fprintf(fd,
+                "window,cycle,region,page,reads,writes,read_bytes,"
+                "write_bytes\n");
+        for (const auto &w : windows) {
+            for (const auto &p : w.second.pages) {
+                const Counters &c = p.second;
+                uint64_t addr = p.first << ADDR_SHIFT;
+                fprintf(fd, "%lu,%lu,%s,0x%lx,%lu,%lu,%lu,%lu\n",
+                        (unsigned long)w.first,
+                        (unsigned long)(w.first * window_cycles),
+                        region_name(region(addr)), (unsigned long)addr,
+                        (unsigned long)c.reads, (unsigned long)c.writes,
+                        (unsigned long)c.read_bytes,
+                        (unsigned long)c.write_bytes);
+            }
+        }
+    }
+
+    static void dump_counters(FILE *fd, const Counters &c) {
+        fprintf(fd,
+                "{\"reads\": %lu, \"writes\": %lu, \"read_bytes\": %lu, "
+                "\"write_bytes\": %lu}",
+                (unsigned long)c.reads, (unsigned long)c.writes,
+                (unsigned long)c.read_bytes, (unsigned long)c.write_bytes);
+    }
+
+    void dump_json(FILE *fd) const {
+        fprintf(fd, "{\n  \"window_cycles\": %lu,\n  \"regions\": {",
+                (unsigned long)window_cycles);
+        for (size_t i = 0; i < regions.size(); i++)
+            fprintf(fd, "%s\"%s\": [%lu, %lu]", i ? ", " : "",
+                    regions[i].name.c_str(), (unsigned long)regions[i].start,
+                    (unsigned long)regions[i].end);
+        fprintf(fd, "},\n  \"windows\": [");
+        bool first_window = true;
+        for (const auto &w : windows) {
+            fprintf(fd, "%s\n    {\"window\": %lu, \"cycle\": %lu,",
+                    first_window ? "" : ",", (unsigned long)w.first,
+                    (unsigned long)(w.first * window_cycles));
+            first_window = false;
+            fprintf(fd, "\n     \"regions\": {");
+            for (size_t i = 0; i < w.second.regions.size(); i++) {
+                fprintf(fd, "%s\"%s\": ", i ? ", " : "", region_name(i));
+                dump_counters(fd, w.second.regions[i]);
+            }
+            fprintf(fd, "},\n     \"pages\": {");
+            bool first_page = true;
+            for (const auto &p : w.second.pages) {
+                fprintf(fd, "%s\n      \"0x%lx\": ", first_page ? "" : ",",
+                        (unsigned long)(p.first << ADDR_SHIFT));
+                first_page = false;
+                dump_counters(fd, p.second);
+            }
+            fprintf(fd, "}}");
+        }
+        fprintf(fd, "\n  ]\n}\n");
+    }
+
+    // Print the traffic and the average and peak bandwidth of each region.
+    void summarize() const {
+        for (size_t i = 0; i <= regions.size(); i++) {
+            uint64_t bytes = 0, peak = 0, active = 0;
+            for (const auto &w : windows) {
+                const Counters &c = w.second.regions[i];
+                uint64_t b = c.read_bytes + c.write_bytes;
+                bytes += b;
+                peak = std::max(peak, b);
+                active += b != 0;
+            }
+            if (!bytes) continue;
+            printf(
+                "[MemStats] %-8s %12lu B, %.2f B/cycle in %lu active "
+                "windows, peak %.2f B/cycle\n",
+                region_name(i), (unsigned long)bytes,
+                (double)bytes / (active * window_cycles),
+                (unsigned long)active, (double)peak / window_cycles);
+        }
+    }
+};
+
+// Counters enabled with `--mem-stats=<file>`, null otherwise.
+extern MemStats *MEM_STATS;
+
+}  // namespace sim
@@ -0,0 +1,63 @@
+// Copyright 2024 KU Leuven.
+// Solderpad Hardware License, Version 0.51, see LICENSE for details.
+// SPDX-License-Identifier: SHL-0.51
+
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+
+#include <vector>
+
+namespace sim {
+
+// Binary recording of the DPI memory access stream. Every access is stored as
+// a fixed header, followed by `len` data bytes and `len` strobe bytes for
+// writes. The stream is replayed against `GlobalMemory` by `membench`.
+struct MemTrace {
+    enum Op : uint32_t {
+        Read = 0,
+        Write = 1,
+    };
+
+    struct Record {
+        uint32_t op;
+        uint32_t len;
+        uint64_t addr;
+    };
+
+    FILE *fd = nullptr;
+
+    explicit MemTrace(const char *path) {
+        fd = fopen(path, "wb");
+        if (!fd) {
+            fprintf(stderr, "[MemTrace] Cannot open `%s`\n", path);
+            return;
+        }
+        // Accesses are tiny; buffer generously to keep the hot path cheap.
+        setvbuf(fd, nullptr, _IOFBF, 1 << 20);
+    }
+
+    ~MemTrace() {
+        if (fd) fclose(fd);
+    }
+
+    void read(uint64_t addr, uint32_t len) {
+        if (!fd) return;
+        Record r = {Read, len, addr};
+        fwrite(&r, sizeof(r), 1, fd);
+    }
+
+    void write(uint64_t addr, uint32_t len, const uint8_t *data,
+               const uint8_t *strb) {
+        if (!fd) return;
+        Record r = {Write, len, addr};
+        fwrite(&r, sizeof(r), 1, fd);
+        fwrite(data, 1, len, fd);
+        fwrite(strb, 1, len, fd);
+    }
+};
+
+// Recorder enabled with `--mem-trace=<file>`, null otherwise.
+extern MemTrace *MEM_TRACE;
+
+}  // namespace sim
@@ -0,0 +1,200 @@
+// Copyright 2024 KU Leuven.
+// Solderpad Hardware License, Version 0.51, see LICENSE for details.
+// SPDX-License-Identifier: SHL-0.51
+
+// Replay a DPI memory access stream recorded with `--mem-trace=<file>`
+// against `GlobalMemory` and report the achieved host throughput. Without a
+// trace, a synthetic stream of wide DMA bursts and narrow strobed core
+// accesses is replayed instead. The optional backend (`map`, `mmap` or
+// `mmap-thp`) mirrors `--mem-backend`, using the default DRAM window.
+//
+// `membench clint [cores] [cycles]` instead measures the host time per
+// simulated cycle of polling the CLINT msip words, once by reading them
+// through the memory every cycle and once from the cached device registers
+// as `clint_tick` does.
+//
+// Usage: membench [trace|-] [iterations] [backend]
+//        membench clint [cores] [cycles]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <vector>
+
+#include "mem_trace.hh"
+#include "tb_lib.hh"
+
+namespace {
+
+// Default DRAM window of the cluster testbench.
+constexpr uint64_t DRAM_BASE = 0x80000000;
+constexpr size_t DRAM_SIZE = 0x80000000;
+
+struct Access {
+    sim::MemTrace::Record rec;
+    size_t payload;  // offset of data and strobes in the payload buffer
+};
+
+struct Stream {
+    std::vector<Access> accesses;
+    std::vector<uint8_t> payload;
+    size_t bytes = 0;
+
+    void push(uint32_t op, uint64_t addr, uint32_t len, const uint8_t *data,
+              const uint8_t *strb) {
+        accesses.push_back({{op, len, addr}, payload.size()});
+        if (op == sim::MemTrace::Write) {
+            payload.insert(payload.end(), data, data + len);
+            payload.insert(payload.end(), strb, strb + len);
+        }
+        bytes += len;
+    }
+};
+
+bool load(const char *path, Stream &s) {
+    FILE *fd = fopen(path, "rb");
+    if (!fd) return false;
+    sim::MemTrace::Record r;
+    std::vector<uint8_t> buf;
+    while (fread(&r, sizeof(r), 1, fd) == 1) {
+        const uint8_t *data = nullptr, *strb = nullptr;
+        if (r.op == sim::MemTrace::Write) {
+            buf.resize(2 * r.len);
+            if (fread(buf.data(), 1, buf.size(), fd) != buf.size()) break;
+            data = buf.data();
+            strb = buf.data() + r.len;
+        }
+        s.push(r.op, r.addr, r.len, data, strb);
+    }
+    fclose(fd);
+    return true;
+}
+
+// Mimic a DMA streaming 64 MiB through 64-byte beats followed by cores doing
+// 8-byte accesses with partial strobes on the same region.
+void synthesize(Stream &s) {
+    const uint64_t base = DRAM_BASE;
+    const uint64_t size = 64 << 20;
+    uint8_t data[64], full[64], partial[8] = {1, 1, 1, 1, 0, 0, 0, 0};
+    for (int i = 0; i < 64; i++) {
+        data[i] = i;
+        full[i] = 1;
+    }
+    for (uint64_t a = 0; a < size; a += 64)
+        s.push(sim::MemTrace::Write, base + a, 64, data, full);
+    for (uint64_t a = 0; a < size; a += 64)
+        s.push(sim::MemTrace::Read, base + a, 64, nullptr, nullptr);
+    for (uint64_t a = 0; a < size / 16; a += 8) {
+        s.push(sim::MemTrace::Write, base + a, 8, data, partial);
+        s.push(sim::MemTrace::Read, base + a, 8, nullptr, nullptr);
+    }
+}
+
+// Poll the msip bits of `cores` cores for `cycles` cycles, with a write to
+// one of the msip words every 1000 cycles.
+void bench_clint(int cores, uint64_t cycles) {
+    const uint64_t base = 0xffff0000;
+    size_t words = (cores + 31) / 32;
+    std::vector<uint8_t> msip(cores);
+    uint64_t sum = 0;
+    double ns[2];
+    for (int cached = 0; cached < 2; cached++) {
+        sim::GlobalMemory mem;
+        auto &clint = mem.add_device(base, words);
+        std::vector<uint8_t> bits(cores);
+        uint64_t version = ~(uint64_t)0;
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t c = 0; c < cycles; c++) {
+            if (c % 1000 == 0) {
+                uint32_t v = (c / 1000) & 1;
+                mem.write(base + 4 * (c / 1000 % words), 4, (uint8_t *)&v,
+                          nullptr);
+            }
+            if (cached) {
+                if (clint.version != version) {
+                    version = clint.version;
+                    for (int i = 0; i < cores; i++)
+                        bits[i] = (clint.regs[i / 32] >> (i % 32)) & 1;
+                }
+                memcpy(msip.data(), bits.data(), cores);
+            } else {
+                uint32_t word = 0;
+                for (int i = 0; i < cores; i++) {
+                    if (i % 32 == 0)
+                        mem.read(base + 4 * (i / 32), sizeof(word),
+                                 (uint8_t *)&word);
+                    msip[i] = (word >> (i % 32)) & 1;
+                }
+            }
+            sum += msip[0];
+        }
+        std::chrono::duration<double, std::nano> t =
+            std::chrono::steady_clock::now() - start;
+        ns[cached] = t.count() / cycles;
+        printf("[membench] CLINT %s: %.2f ns per cycle\n",
+               cached ? "cached" : "through memory", ns[cached]);
+    }
+    // Print the polled bits such that the loops are not optimized out.
+    printf("[membench] CLINT speedup %.1fx (checksum %lu)\n", ns[0] / ns[1],
+           (unsigned long)sum);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "clint") == 0) {
+        int cores = argc > 2 ? atoi(argv[2]) : 9;
+        uint64_t cycles = argc > 3 ? strtoull(argv[3], 0, 0) : 100000000;
+        printf("[membench] Polling CLINT of %d cores for %lu cycles\n", cores,
+               (unsigned long)cycles);
+        bench_clint(cores, cycles);
+        return 0;
+    }
+    Stream s;
+    if (argc > 1 && strcmp(argv[1], "-") != 0) {
+        if (!load(argv[1], s)) {
+            fprintf(stderr, "[membench] Cannot read trace `%s`\n", argv[1]);
+            return 1;
+        }
+    } else {
+        synthesize(s);
+    }
+    int iterations = argc > 2 ? atoi(argv[2]) : 5;
+    const char *backend = argc > 3 ? argv[3] : "map";
+    bool mmap = strncmp(backend, "mmap", 4) == 0;
+    bool thp = strcmp(backend, "mmap-thp") == 0;
+    printf("[membench] %zu accesses, %zu bytes per iteration, %s backend\n",
+           s.accesses.size(), s.bytes, backend);
+
+    uint8_t buf[4096];
+    double best = 0;
+    for (int it = 0; it < iterations; it++) {
+        sim::GlobalMemory mem;
+        if (mmap && !mem.reserve(DRAM_BASE, DRAM_SIZE, thp)) {
+            perror("[membench] mmap");
+            return 1;
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (const auto &a : s.accesses) {
+            if (a.rec.op == sim::MemTrace::Write) {
+                const uint8_t *data = &s.payload[a.payload];
+                mem.write(a.rec.addr, a.rec.len, data, data + a.rec.len);
+            } else {
+                for (uint32_t off = 0; off < a.rec.len; off += sizeof(buf))
+                    mem.read(a.rec.addr + off,
+                             std::min<uint32_t>(sizeof(buf), a.rec.len - off),
+                             buf);
+            }
+        }
+        std::chrono::duration<double> t =
+            std::chrono::steady_clock::now() - start;
+        double bps = s.bytes / t.count();
+        best = std::max(best, bps);
+        printf("[membench] Iteration %d: %.3f s, %.1f MB/s, %.2f Maccess/s\n",
+               it, t.count(), bps / 1e6, s.accesses.size() / t.count() / 1e6);
+    }
+    printf("[membench] Best: %.1f MB/s\n", best / 1e6);
+    return 0;
+}
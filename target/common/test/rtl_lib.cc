@@ -5,10 +5,12 @@
 #include <svdpi.h>
 #include <vpi_user.h>
 
+#include <cmath>
 #include <iostream>
 #include <memory>
 
 #include "sim.hh"
+#include "sim_ctrl.hh"
 #include "tb_lib.hh"
 
 /// DPI Functions.
@@ -26,12 +28,7 @@ namespace sim {
 void sim_thread_main(void *arg) { ((Sim *)arg)->main(); }
 
 Sim::Sim(int argc, char **argv) : htif_t(argc, argv), ipc(argc, argv) {
-    for (auto i = 1; i < argc; ++i) {
-        if (strcmp(argv[i], "--disable_preloading") == 0) {
-            printf("fesvr-based binary preloading disabled\n");
-            disable_preloading = true;
-        }
-    }
+    parse_common_args(argc, argv);
     host = context_t::current();
     target.init(sim_thread_main, this);
     target.switch_to();
@@ -59,6 +56,15 @@ void Sim::main() {
 
 std::unique_ptr<sim::Sim> s;
 
+// Current cycle of the 1 ns clock in `tb_bin.sv`.
+static uint64_t sim_cycle() {
+    static const double scale = pow(10, vpi_get(vpiTimePrecision, NULL) + 9);
+    s_vpi_time t;
+    t.type = vpiSimTime;
+    vpi_get_time(NULL, &t);
+    return ((uint64_t)t.high << 32 | t.low) * scale;
+}
+
 int fesvr_tick() {
     // Initialize on first tick.
     if (s == nullptr) {
@@ -117,6 +123,8 @@ void tb_memory_read(long long addr, int len, const svOpenArrayHandle data) {
     //           << " bytes)\n";
     void *data_ptr = svGetArrayPtr(data);
     assert(data_ptr);
+    if (sim::MEM_TRACE) sim::MEM_TRACE->read(addr, len);
+    if (sim::MEM_STATS) sim::MEM_STATS->read(sim_cycle(), addr, len);
     sim::MEM.read(addr, len, (uint8_t *)data_ptr);
 }
 
@@ -128,21 +136,11 @@ void tb_memory_write(long long addr, int len, const svOpenArrayHandle data,
     const void *strb_ptr = svGetArrayPtr(strb);
     assert(data_ptr);
     assert(strb_ptr);
+    if (sim::MEM_TRACE)
+        sim::MEM_TRACE->write(addr, len, (const uint8_t *)data_ptr,
+                              (const uint8_t *)strb_ptr);
+    if (sim::CTRL.enabled) sim::CTRL.check_write(addr, len);
+    if (sim::MEM_STATS) sim::MEM_STATS->write(sim_cycle(), addr, len);
     sim::MEM.write(addr, len, (const uint8_t *)data_ptr,
                    (const uint8_t *)strb_ptr);
 }
-
-const long long clint_addr = sim::BOOTDATA.clint_base;
-const long num_cores = sim::BOOTDATA.core_count;
-
-void clint_tick(const svOpenArrayHandle msip) {
-    uint8_t *msip_ptr = (uint8_t *)svGetArrayPtr(msip);
-    assert(msip_ptr);
-    uint32_t read_val;
-    for (int i = 0; i < num_cores; i++) {
-        if (i % 32 == 0)
-            sim::MEM.read(clint_addr + i / 32, sizeof(uint32_t),
-                          (uint8_t *)&read_val);
-        msip_ptr[i] = (read_val & (1 << (i % 32))) != 0 ? 1 : 0;
-    }
-}
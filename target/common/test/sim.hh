@@ -9,12 +9,16 @@
 #include <chrono>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <set>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "ipc.hh"
+#include "mem_stats.hh"
+#include "mem_trace.hh"
 
 namespace sim {
 using namespace std::chrono_literals;
@@ -32,7 +36,7 @@ struct Sim : htif_t {
     void read_chunk(addr_t taddr, size_t len, void *dst);
     void write_chunk(addr_t taddr, size_t len, const void *src);
     bool is_address_preloaded(addr_t taddr, size_t len) override {
-        return disable_preloading;
+        return disable_preloading || elf_preloaded;
     }
 
     void idle();
@@ -44,12 +48,50 @@ struct Sim : htif_t {
 
     void reset() {}
 
+    // Simulated cycles and wall time of `run`, for batch summaries.
+    uint64_t cycles = 0;
+    double seconds = 0;
+
+    ~Sim();
+
    private:
     context_t *host;
     context_t target;
-    bool vlt_vcd = false;
+    // Set once HTIF finished, to stop the clock loop.
+    bool finished = false;
+    // Waves of the Verilator model, dumped for cycles in `[wave_start,
+    // wave_stop)` while the optional marker word is nonzero.
+    bool waves = false;
+    uint64_t wave_start = 0;
+    uint64_t wave_stop = std::numeric_limits<uint64_t>::max();
+    std::string wave_marker;
+    uint64_t wave_marker_addr = 0;
+    int wave_depth = 8;
+    std::string wave_scope;
     bool disable_preloading = false;
+    bool elf_preloaded = false;
     IpcIface ipc;
+    std::unique_ptr<MemTrace> mem_trace;
+    std::unique_ptr<MemStats> mem_stats;
+    // Checkpointing of the Verilator model, see `verilator_lib.cc`.
+    uint64_t checkpoint_cycle = 0;
+    std::string checkpoint_marker;
+    std::string checkpoint_file = "sim.ckpt";
+    std::string restore_file;
+    // Set whenever the host writes tohost or fromhost.
+    bool htif_active = false;
+    // Address of `tohost`, watched to switch to the host when it is written.
+    uint64_t htif_tohost = 0;
+    // Sim time and wall clock at the start of simulation.
+    uint64_t sim_start_time = 0;
+    std::chrono::steady_clock::time_point sim_start =
+        std::chrono::steady_clock::now();
+
+    // Parse the options shared by all simulator flavors.
+    void parse_common_args(int argc, char **argv);
+    bool preload_elf(const std::string &path);
+    // Look up the address of `name` in the simulated binary.
+    bool elf_symbol(const std::string &name, uint64_t &addr);
 };
 
 void sim_thread_main(void *arg);
@@ -0,0 +1,221 @@
+// Copyright 2024 KU Leuven.
+// Solderpad Hardware License, Version 0.51, see LICENSE for details.
+// SPDX-License-Identifier: SHL-0.51
+
+#pragma once
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+
+namespace sim {
+
+// Control of the clock loop by an IPC host: pause, resume, run for a number
+// of cycles or until a breakpoint. The IPC thread calls the blocking request
+// methods, while the simulation thread calls `tick` once per cycle and parks
+// in there while paused. All checks on the simulation side are skipped until
+// a host first takes control.
+struct SimControl {
+    // Why the simulation stopped, as reported to the host.
+    enum Reason : uint64_t {
+        Paused = 0,       // by the host or after the requested cycles
+        PcBreak = 1,      // an instruction at a PC breakpoint retired
+        WriteBreak = 2,   // the DUT wrote to a write breakpoint
+        Finished = 3,     // the simulation ended
+        Unsupported = 4,  // the simulator cannot be controlled
+    };
+
+#ifdef SNITCH_TRACE_BINARY
+    static constexpr bool BINARY_TRACE = true;
+#else
+    static constexpr bool BINARY_TRACE = false;
+#endif
+
+    std::atomic<bool> enabled{false};
+    std::atomic<bool> has_pc_breaks{false};
+    // Bounding box of all write breakpoints, to skip the lock on most writes.
+    std::atomic<uint64_t> write_lo{std::numeric_limits<uint64_t>::max()};
+    std::atomic<uint64_t> write_hi{0};
+    // Saves a checkpoint of the paused model, if the simulator supports it.
+    std::function<bool(const std::string &)> checkpoint;
+
+    // Called by a simulator whose clock loop calls `tick`, with a getter of
+    // its time.
+    void attach(std::function<uint64_t()> t) {
+        std::lock_guard<std::mutex> lock(mtx);
+        get_time = t;
+        finished = false;
+    }
+
+    // Stop at the end of the current cycle.
+    void request_stop() { enabled = stop = true; }
+
+    // Simulation side: called at the end of every cycle while `enabled`.
+    void tick(uint64_t cycle) {
+        if (!stop && cycle < stop_at) return;
+        std::unique_lock<std::mutex> lock(mtx);
+        stop = false;
+        stop_at = std::numeric_limits<uint64_t>::max();
+        paused = true;
+        paused_cycle = cycle;
+        stop_reason = reason;
+        reason = Paused;
+        stops++;
+        cv.notify_all();
+        while (paused) {
+            cv.wait(lock);
+            if (!checkpoint_path.empty()) {
+                checkpoint_ok = checkpoint && checkpoint(checkpoint_path);
+                checkpoint_path.clear();
+                cv.notify_all();
+            }
+        }
+    }
+
+    // Simulation side: the simulation ended, release all waiting requests.
+    void finish() {
+        std::lock_guard<std::mutex> lock(mtx);
+        finished = true;
+        cv.notify_all();
+    }
+
+    // Simulation side: an instruction at `pc` retired.
+    void check_pc(uint32_t pc) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (pc_breaks.count(pc)) hit(PcBreak);
+    }
+
+    // Simulation side: the DUT wrote `[addr, addr + len)`.
+    void check_write(uint64_t addr, uint64_t len) {
+        if (!(write_lo.load() < addr + len && addr < write_hi.load())) return;
+        std::lock_guard<std::mutex> lock(mtx);
+        for (const auto &w : write_breaks)
+            if (w.first < addr + len && addr < w.second) hit(WriteBreak);
+    }
+
+    // Host side: pause and return the cycle the simulation stopped at.
+    uint64_t pause(uint64_t &why) {
+        if (!get_time) return unsupported(why);
+        std::unique_lock<std::mutex> lock(mtx);
+        if (!paused) {
+            uint64_t seen = stops;
+            request_stop();
+            cv.wait(lock, [&] { return stops != seen || finished; });
+        }
+        why = finished ? Finished : stop_reason;
+        return finished ? time() / 2 : paused_cycle;
+    }
+
+    // Host side: continue without waiting for the next stop.
+    void resume() {
+        std::lock_guard<std::mutex> lock(mtx);
+        paused = false;
+        cv.notify_all();
+    }
+
+    // Host side: continue for `cycles` cycles, or until a breakpoint if
+    // zero, and wait for the simulation to stop again.
+    uint64_t run(uint64_t cycles, uint64_t &why) {
+        uint64_t cycle = pause(why);
+        if (why == Finished || why == Unsupported) return cycle;
+        std::unique_lock<std::mutex> lock(mtx);
+        uint64_t seen = stops;
+        if (cycles) stop_at = cycle + cycles;
+        paused = false;
+        cv.notify_all();
+        cv.wait(lock, [&] { return stops != seen || finished; });
+        why = finished ? Finished : stop_reason;
+        return finished ? time() / 2 : paused_cycle;
+    }
+
+    // Host side: the simulation time, two steps per cycle.
+    uint64_t time() const { return get_time ? get_time() : 0; }
+
+    // Host side: set or clear a PC breakpoint and return the cycle. PCs are
+    // checked on the records of the binary tracer, so without it `why` is
+    // `Unsupported` and the breakpoint is ignored.
+    uint64_t break_pc(uint32_t pc, bool set, uint64_t &why) {
+        if (!BINARY_TRACE || !get_time) return unsupported(why);
+        std::lock_guard<std::mutex> lock(mtx);
+        enabled = true;
+        if (set)
+            pc_breaks.insert(pc);
+        else
+            pc_breaks.erase(pc);
+        has_pc_breaks = !pc_breaks.empty();
+        why = Paused;
+        return time() / 2;
+    }
+
+    // Host side: set a write breakpoint on `[addr, addr + len)`, or clear
+    // all breakpoints starting at `addr` if `len` is zero.
+    void break_write(uint64_t addr, uint64_t len) {
+        std::lock_guard<std::mutex> lock(mtx);
+        enabled = true;
+        if (len) {
+            write_breaks.emplace(addr, addr + len);
+        } else {
+            write_breaks.erase(write_breaks.lower_bound({addr, 0}),
+                               write_breaks.lower_bound({addr + 1, 0}));
+        }
+        uint64_t lo = std::numeric_limits<uint64_t>::max(), hi = 0;
+        for (const auto &w : write_breaks) {
+            lo = std::min(lo, w.first);
+            hi = std::max(hi, w.second);
+        }
+        write_lo = lo;
+        write_hi = hi;
+    }
+
+    // Host side: save a checkpoint of the paused simulation to `path`.
+    bool save_checkpoint(const std::string &path) {
+        uint64_t why;
+        pause(why);
+        if (why == Finished || why == Unsupported) return false;
+        std::unique_lock<std::mutex> lock(mtx);
+        checkpoint_path = path;
+        cv.notify_all();
+        cv.wait(lock, [&] { return checkpoint_path.empty(); });
+        return checkpoint_ok;
+    }
+
+   private:
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::function<uint64_t()> get_time;
+    bool paused = false;
+    bool finished = false;
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> stop_at{std::numeric_limits<uint64_t>::max()};
+    uint64_t paused_cycle = 0;
+    uint64_t stops = 0;
+    uint64_t reason = Paused;
+    uint64_t stop_reason = Paused;
+    std::set<uint32_t> pc_breaks;
+    std::set<std::pair<uint64_t, uint64_t>> write_breaks;
+    std::string checkpoint_path;
+    bool checkpoint_ok = false;
+
+    // Stop at the end of the current cycle, with `mtx` held.
+    void hit(Reason why) {
+        reason = why;
+        stop = true;
+    }
+
+    uint64_t unsupported(uint64_t &why) {
+        why = Unsupported;
+        return 0;
+    }
+};
+
+// Controls the clock loop of the simulator, see `--ipc`.
+extern SimControl CTRL;
+
+}  // namespace sim
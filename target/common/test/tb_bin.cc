@@ -3,21 +3,153 @@
 // SPDX-License-Identifier: SHL-0.51
 
 #include <printf.h>
+#include <string.h>
+
+#include <fstream>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "sim.hh"
+#include "tb_lib.hh"
 
-int main(int argc, char **argv, char **env) {
-    // Write binary path to logs/binary for the `make annotate` target
+// Write binary path to logs/binary for the `make annotate` target
+static void write_binary_name(const char *path) {
     FILE *fd;
     fd = fopen("logs/.rtlbinary", "w");
-    if (fd != NULL && argc >= 2) {
-        fprintf(fd, "%s\n", argv[1]);
+    if (fd != NULL) {
+        fprintf(fd, "%s\n", path);
         fclose(fd);
     } else {
         fprintf(stderr,
                 "Warning: Failed to write binary name to logs/.rtlbinary\n");
     }
+}
+
+static bool has_prefix(const char *arg, const char *prefix) {
+    return strncmp(arg, prefix, strlen(prefix)) == 0;
+}
+
+// Remove the options starting with any of `prefixes` from `args`.
+static void strip_args(std::vector<char *> &args,
+                       std::initializer_list<const char *> prefixes) {
+    for (size_t i = 2; i < args.size();) {
+        bool match = false;
+        for (const char *p : prefixes) match |= has_prefix(args[i], p);
+        if (match)
+            args.erase(args.begin() + i);
+        else
+            i++;
+    }
+}
+
+// Quote `str` as a JSON string.
+static std::string json_string(const std::string &str) {
+    std::string out = "\"";
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if ((unsigned char)c < 0x20) {
+            char esc[8];
+            snprintf(esc, sizeof(esc), "\\u%04x", c);
+            out += esc;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+// Simulate each binary listed in `list`, one path per line, on the same model.
+// The DUT is reset and the global memory cleared before every binary, which
+// saves building the model and starting the process per test. Each
+// simulation is torn down once its binary finished. The exit code, simulated
+// cycles and wall time of each binary are written to `summary`, as a JSON
+// array with one object per line.
+static int run_batch(const char *list, const char *summary,
+                     std::vector<char *> args) {
+    std::ifstream in(list);
+    if (!in) {
+        fprintf(stderr, "[Batch] Cannot open `%s`\n", list);
+        return 1;
+    }
+    std::vector<std::string> elfs;
+    for (std::string line; std::getline(in, line);)
+        if (!line.empty()) elfs.push_back(line);
+
+    FILE *out = fopen(summary, "w");
+    if (!out) {
+        fprintf(stderr, "[Batch] Cannot open `%s`\n", summary);
+        return 1;
+    }
+
+    // The IPC thread serves all binaries, so it is owned by the batch.
+    IpcIface ipc(args.size(), args.data());
+    strip_args(args, {"--ipc,", "--ipc-shm,"});
+
+    int failed = 0;
+    fprintf(out, "[\n");
+    for (size_t i = 0; i < elfs.size(); i++) {
+        printf("[Batch] Running `%s` (%lu/%lu)\n", elfs[i].c_str(),
+               (unsigned long)(i + 1), (unsigned long)elfs.size());
+        write_binary_name(elfs[i].c_str());
+        sim::MEM.clear();
+        args[1] = &elfs[i][0];
+        auto sim = std::make_unique<sim::Sim>(args.size(), args.data());
+        // File mappings, the memory backend and the initial pause are set up
+        // for the process, with the first binary.
+        if (i == 0) strip_args(args, {"--map=", "--mem-backend=", "--paused"});
+        int exit_code = sim->run();
+        if (exit_code) failed++;
+        fprintf(out,
+                "  {\"elf\": %s, \"exit_code\": %d, \"cycles\": %lu, "
+                "\"seconds\": %.6f}%s\n",
+                json_string(elfs[i]).c_str(), exit_code,
+                (unsigned long)sim->cycles, sim->seconds,
+                i + 1 < elfs.size() ? "," : "");
+        fflush(out);
+    }
+    fprintf(out, "]\n");
+    fclose(out);
+    printf("[Batch] %d of %lu binaries failed, summary in `%s`\n", failed,
+           (unsigned long)elfs.size(), summary);
+    return failed != 0;
+}
+
+int main(int argc, char **argv, char **env) {
+    // Batch mode replaces the binary by `--batch=<list>`. All other options
+    // are passed on to the simulation of each binary.
+    const char *BATCH_FLAG = "--batch=";
+    const char *SUMMARY_FLAG = "--batch-summary=";
+    const char *list = nullptr, *summary = "batch.json";
+    std::vector<char *> args = {argv[0], nullptr};
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], BATCH_FLAG, strlen(BATCH_FLAG)) == 0) {
+            list = argv[i] + strlen(BATCH_FLAG);
+        } else if (strncmp(argv[i], SUMMARY_FLAG, strlen(SUMMARY_FLAG)) == 0) {
+            summary = argv[i] + strlen(SUMMARY_FLAG);
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    if (list) {
+        // Waves and checkpoints belong to a single binary.
+        for (size_t i = 2; i < args.size(); i++) {
+            for (const char *f : {"--vcd", "--wave", "--checkpoint-at=",
+                                  "--restore="}) {
+                if (strncmp(args[i], f, strlen(f)) == 0) {
+                    fprintf(stderr, "[Batch] `%s` is not supported\n",
+                            args[i]);
+                    return 1;
+                }
+            }
+        }
+        return run_batch(list, summary, args);
+    }
 
+    if (argc >= 2) write_binary_name(argv[1]);
     auto sim = std::make_unique<sim::Sim>(argc, argv);
     return sim->run();
 }
@@ -6,7 +6,20 @@
 // Author: Florian Zaruba <zarubaf@iis.ee.ethz.ch>
 
 #pragma once
-#include "sim.hh"
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
 
 namespace sim {
 
@@ -14,8 +27,64 @@ struct GlobalMemory {
     static constexpr size_t ADDR_SHIFT = 12;
     static constexpr size_t PAGE_SIZE = (size_t)1 << ADDR_SHIFT;
 
-    std::unordered_map<uint64_t, std::unique_ptr<uint8_t[]>> pages;
-    std::set<uint64_t> touched;
+    // Optional flat backend covering one window of the address space with a
+    // single anonymous mapping. Translation inside the window is one add and
+    // zero pages come from the kernel; addresses outside it use `pages`.
+    uint64_t flat_base = 0;
+    size_t flat_size = 0;
+    uint8_t *flat = nullptr;
+
+    GlobalMemory() = default;
+    GlobalMemory(const GlobalMemory &) = delete;
+    GlobalMemory &operator=(const GlobalMemory &) = delete;
+
+    ~GlobalMemory() {
+        if (flat) munmap(flat, flat_size);
+    }
+
+    // Reserve `[base, base + size)` for the flat backend, optionally backed by
+    // transparent huge pages. Must be called before the window is accessed.
+    bool reserve(uint64_t base, size_t size, bool huge_pages) {
+        uint64_t end = base + size;
+        base &= ~(uint64_t)(PAGE_SIZE - 1);
+        size = page_end(end - 1) - base;
+        void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (p == MAP_FAILED) return false;
+#ifdef MADV_HUGEPAGE
+        if (huge_pages) madvise(p, size, MADV_HUGEPAGE);
+#endif
+        std::lock_guard<std::mutex> lock(page_mtx);
+        if (flat) munmap(flat, flat_size);
+        flat = (uint8_t *)p;
+        flat_base = base;
+        flat_size = size;
+        flat_touched.assign(size >> ADDR_SHIFT, false);
+        epoch++;
+        return true;
+    }
+
+    // Zero all memory, e.g. before running the next binary of a batch. Host
+    // mappings and watchpoints are kept.
+    void clear() {
+        {
+            std::lock_guard<std::mutex> lock(page_mtx);
+            pages.clear();
+            touched.clear();
+            if (flat) {
+                madvise(flat, flat_size, MADV_DONTNEED);
+                flat_touched.assign(flat_touched.size(), false);
+            }
+            epoch++;
+        }
+        refresh_devices(0, std::numeric_limits<uint64_t>::max());
+    }
+
+    // Indices of all pages written so far, in ascending order.
+    std::vector<uint64_t> touched_pages() {
+        std::lock_guard<std::mutex> lock(page_mtx);
+        return std::vector<uint64_t>(touched.begin(), touched.end());
+    }
 
     // A mapping of host memory into Manticore memory.
     struct Mapping {
@@ -23,58 +92,141 @@ struct GlobalMemory {
         size_t size;
         uint8_t *into;  // host memory
     };
+    // Mappings are kept sorted by base address and must not overlap, such
+    // that a lookup is a binary search. Use `add_mapping` to insert.
     std::vector<Mapping> mappings;
 
-    uint8_t *find_mapping(uint64_t addr) const {
-        for (const auto &m : mappings) {
-            if (m.base <= addr && m.base + m.size > addr) {
-                return m.into + (addr - m.base);
-            }
+    void add_mapping(uint64_t base, size_t size, uint8_t *into) {
+        auto it = std::upper_bound(
+            mappings.begin(), mappings.end(), base,
+            [](uint64_t a, const Mapping &m) { return a < m.base; });
+        mappings.insert(it, Mapping{base, size, into});
+    }
+
+    void remove_mapping(uint64_t base) {
+        mappings.erase(
+            std::remove_if(mappings.begin(), mappings.end(),
+                           [&](const Mapping &m) { return m.base == base; }),
+            mappings.end());
+    }
+
+    // Look up the host memory backing `addr`, if any. `limit` is set to the
+    // first address past the mapped (or unmapped) span containing `addr`, so
+    // callers resolve mappings once per span rather than once per byte.
+    uint8_t *find_mapping(uint64_t addr, uint64_t &limit) const {
+        limit = std::numeric_limits<uint64_t>::max();
+        if (mappings.empty()) return nullptr;
+        auto it = std::upper_bound(
+            mappings.begin(), mappings.end(), addr,
+            [](uint64_t a, const Mapping &m) { return a < m.base; });
+        if (it != mappings.end()) limit = it->base;
+        if (it == mappings.begin()) return nullptr;
+        const auto &m = *std::prev(it);
+        if (m.base + m.size > addr) {
+            limit = m.base + m.size;
+            return m.into + (addr - m.base);
         }
         return nullptr;
     }
 
-    // Copy a chunk of data into memory.
+    uint8_t *find_mapping(uint64_t addr) const {
+        uint64_t limit;
+        return find_mapping(addr, limit);
+    }
+
+    // Copy a chunk of data into memory. A null or all-ones strobe copies whole
+    // page spans; partial strobes fall back to per-byte masking.
     void write(size_t addr, size_t len, const uint8_t *data,
                const uint8_t *strb) {
         // std::cout << "[GlobalMemory] Write " << std::hex << addr << std::dec
         //           << " (" << len << " bytes)\n";
-        size_t end = addr + len;
-        size_t data_idx = 0;
+        if (strb && std::all_of(strb, strb + len, [](uint8_t s) { return s; }))
+            strb = nullptr;
+        bool watched = watch_lo.load() < addr + len && addr < watch_hi.load();
+        size_t start = addr, end = addr + len;
         while (addr < end) {
-            size_t byte_start = addr;
-            addr >>= ADDR_SHIFT;
-            auto &page = pages[addr];
-            uint64_t page_idx = addr;
-            if (!page) {
-                // std::cout << "[TB] Allocate page " << std::hex << (addr <<
-                // ADDR_SHIFT) << "\n";
-                page = std::make_unique<uint8_t[]>(PAGE_SIZE);
-                std::fill(&page[0], &page[PAGE_SIZE], 0);
+            uint64_t limit;
+            uint8_t *dst = find_mapping(addr, limit);
+            size_t span_end = std::min<uint64_t>(end, limit);
+            bool mapped = dst != nullptr;
+            if (!mapped) {
+                span_end = std::min(span_end, span_limit(addr));
+                dst = backing(addr, true);
             }
-            // std::cout << "[TB] Write to page " << std::hex << (addr <<
-            // ADDR_SHIFT)
-            // << "\n";
-            addr += 1;
-            addr <<= ADDR_SHIFT;
-            size_t byte_end = std::min(addr, end);
-            bool any_changed = false;
-            for (size_t i = byte_start; i < byte_end; i++, data_idx++) {
-                if (!strb || strb[data_idx]) {
-                    // std::cout << "[TB] Write byte " << std::hex << i << " = "
-                    // << (uint32_t)data[data_idx] << "\n";
-                    auto host = find_mapping(i);
-                    if (host) {
-                        *host = data[data_idx];
-                    } else {
-                        page[i % PAGE_SIZE] = data[data_idx];
+            size_t n = span_end - addr;
+            bool any_changed = true;
+            if (!strb) {
+                std::memcpy(dst, data, n);
+            } else {
+                any_changed = false;
+                for (size_t i = 0; i < n; i++) {
+                    if (strb[i]) {
+                        dst[i] = data[i];
                         any_changed = true;
                     }
                 }
+                strb += n;
             }
-            if (any_changed) touched.insert(page_idx);
+            if (any_changed && !mapped) {
+                for (uint64_t i = addr >> ADDR_SHIFT;
+                     i <= (span_end - 1) >> ADDR_SHIFT; i++)
+                    touch(i);
+            }
+            data += n;
+            addr = span_end;
         }
-        std::cout << std::dec;
+        if (start < device_hi && device_lo < end) refresh_devices(start, end);
+        if (watched) notify_watchers(start, len);
+    }
+
+    // Registers of a device the testbench polls every cycle, e.g. the CLINT
+    // msip words. Memory stays authoritative, but every write into the
+    // device refreshes `regs` and bumps `version`, so pollers need not read
+    // through the memory while nothing changed.
+    struct Device {
+        uint64_t base;
+        std::vector<uint32_t> regs;
+        std::atomic<uint64_t> version{0};
+    };
+
+    Device &add_device(uint64_t base, size_t words) {
+        devices.push_back(std::make_unique<Device>());
+        Device &d = *devices.back();
+        d.base = base;
+        d.regs.resize(words);
+        device_lo = std::min<uint64_t>(device_lo, base);
+        device_hi = std::max<uint64_t>(device_hi, base + 4 * words);
+        refresh_devices(base, base + 4 * words);
+        return d;
+    }
+
+    // Watch `[addr, addr + len)` for writes. Threads blocked in
+    // `wait_for_write` are woken whenever a write touches a watched range.
+    void watch(uint64_t addr, size_t len) {
+        std::lock_guard<std::mutex> lock(watch_mtx);
+        watches.emplace(addr, addr + len);
+        update_watch_bounds();
+    }
+
+    void unwatch(uint64_t addr, size_t len) {
+        std::lock_guard<std::mutex> lock(watch_mtx);
+        auto it = watches.find({addr, addr + len});
+        if (it != watches.end()) watches.erase(it);
+        update_watch_bounds();
+    }
+
+    // Number of writes to watched ranges so far. Sample this before checking
+    // memory and pass it to `wait_for_write` to not miss intervening writes.
+    uint64_t watch_generation() const { return watch_gen.load(); }
+
+    // Block until a watched range was written since `generation` or until
+    // `timeout` expires. Returns whether a write happened.
+    template <class Rep, class Period>
+    bool wait_for_write(uint64_t generation,
+                        std::chrono::duration<Rep, Period> timeout) {
+        std::unique_lock<std::mutex> lock(watch_mtx);
+        return watch_cv.wait_for(lock, timeout,
+                                 [&] { return watch_gen != generation; });
     }
 
     // Copy a chunk of data out of the memory.
@@ -82,33 +234,161 @@ struct GlobalMemory {
         // std::cout << "[GlobalMemory] Read " << std::hex << addr << std::dec
         //           << " (" << len << " bytes)\n";
         size_t end = addr + len;
-        size_t data_idx = 0;
         while (addr < end) {
-            size_t byte_start = addr;
-            addr >>= ADDR_SHIFT;
-            auto &page = pages[addr];
-            // std::cout << "[TB] Read from page " << std::hex << (addr <<
-            // ADDR_SHIFT)
-            // << "\n";
-            addr += 1;
-            addr <<= ADDR_SHIFT;
-            size_t byte_end = std::min(addr, end);
-            for (size_t i = byte_start; i < byte_end; i++, data_idx++) {
-                auto host = find_mapping(i);
-                if (host) {
-                    data[data_idx] = *host;
-                } else {
-                    if (page) {
-                        // std::cout << "[TB] Read byte " << std::hex << i <<
-                        // "\n";
-                        data[data_idx] = page[i % PAGE_SIZE];
-                    } else {
-                        data[data_idx] = 0;
-                    }
-                }
+            uint64_t limit;
+            const uint8_t *src = find_mapping(addr, limit);
+            size_t span_end = std::min<uint64_t>(end, limit);
+            if (!src) {
+                span_end = std::min(span_end, span_limit(addr));
+                src = backing(addr, false);
+            }
+            size_t n = span_end - addr;
+            // Untouched pages read as zero without being allocated.
+            if (src) {
+                std::memcpy(data, src, n);
+            } else {
+                std::memset(data, 0, n);
+            }
+            data += n;
+            addr = span_end;
+        }
+    }
+
+   private:
+    std::vector<std::unique_ptr<Device>> devices;
+    uint64_t device_lo = std::numeric_limits<uint64_t>::max();
+    uint64_t device_hi = 0;
+
+    void refresh_devices(uint64_t start, uint64_t end) {
+        for (auto &d : devices) {
+            uint64_t len = 4 * d->regs.size();
+            if (start < d->base + len && d->base < end) {
+                read(d->base, len, (uint8_t *)d->regs.data());
+                d->version++;
+            }
+        }
+    }
+
+    // Watched ranges as `[start, end)` and their bounding box, which lets
+    // writes skip the lock unless they may hit a watch.
+    std::mutex watch_mtx;
+    std::condition_variable watch_cv;
+    std::multiset<std::pair<uint64_t, uint64_t>> watches;
+    std::atomic<uint64_t> watch_lo{std::numeric_limits<uint64_t>::max()};
+    std::atomic<uint64_t> watch_hi{0};
+    // Only modified with `watch_mtx` held, but cheap to sample every cycle.
+    std::atomic<uint64_t> watch_gen{0};
+
+    void update_watch_bounds() {
+        uint64_t lo = std::numeric_limits<uint64_t>::max(), hi = 0;
+        for (const auto &w : watches) {
+            lo = std::min(lo, w.first);
+            hi = std::max(hi, w.second);
+        }
+        watch_lo = lo;
+        watch_hi = hi;
+    }
+
+    void notify_watchers(uint64_t addr, size_t len) {
+        std::lock_guard<std::mutex> lock(watch_mtx);
+        for (const auto &w : watches) {
+            if (w.first < addr + len && addr < w.second) {
+                watch_gen++;
+                watch_cv.notify_all();
+                return;
+            }
+        }
+    }
+
+    // Pages are allocated by both the simulation and the IPC thread, so the
+    // page map and the touched sets are only accessed with `page_mtx` held.
+    std::mutex page_mtx;
+    std::unordered_map<uint64_t, std::unique_ptr<uint8_t[]>> pages;
+    std::set<uint64_t> touched;
+    std::vector<bool> flat_touched;
+    // Bumped whenever pages are freed, which invalidates all page caches.
+    std::atomic<uint64_t> epoch{0};
+
+    // Most DPI beats hit the same page as the previous one, so each thread
+    // caches its last page lookup to skip the lock and the hash map.
+    struct PageCache {
+        const GlobalMemory *mem = nullptr;
+        uint64_t epoch = 0;
+        uint64_t idx = 0;
+        uint8_t *page = nullptr;
+        bool touched = false;
+    };
+
+    PageCache &cache() {
+        thread_local PageCache c;
+        uint64_t e = epoch.load();
+        if (c.mem != this || c.epoch != e) c = PageCache{this, e};
+        return c;
+    }
+
+    static size_t page_end(size_t addr) {
+        return ((addr >> ADDR_SHIFT) + 1) << ADDR_SHIFT;
+    }
+
+    bool in_flat(uint64_t addr) const {
+        return addr - flat_base < flat_size;
+    }
+
+    // End of the contiguous host span backing `addr`.
+    size_t span_limit(size_t addr) const {
+        return in_flat(addr) ? flat_base + flat_size : page_end(addr);
+    }
+
+    // Host pointer backing `addr`, or null for unallocated pages if `alloc`
+    // is not set.
+    uint8_t *backing(size_t addr, bool alloc) {
+        if (in_flat(addr)) return flat + (addr - flat_base);
+        uint8_t *p = page(addr >> ADDR_SHIFT, alloc);
+        return p ? p + (addr % PAGE_SIZE) : nullptr;
+    }
+
+    // Return the page with index `idx`, allocating a zeroed page if `alloc`
+    // is set. Returns null for unallocated pages otherwise.
+    uint8_t *page(uint64_t idx, bool alloc) {
+        PageCache &c = cache();
+        if (idx == c.idx && c.page) return c.page;
+        uint8_t *p = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(page_mtx);
+            auto it = pages.find(idx);
+            if (it != pages.end()) {
+                p = it->second.get();
+            } else if (alloc) {
+                // std::cout << "[TB] Allocate page " << std::hex << (idx <<
+                // ADDR_SHIFT) << "\n";
+                p = new uint8_t[PAGE_SIZE]();
+                pages.emplace(idx, std::unique_ptr<uint8_t[]>(p));
+            }
+        }
+        if (p) {
+            c.idx = idx;
+            c.page = p;
+            c.touched = false;
+        }
+        return p;
+    }
+
+    void touch(uint64_t idx) {
+        PageCache &c = cache();
+        if (idx == c.idx && c.touched) return;
+        {
+            std::lock_guard<std::mutex> lock(page_mtx);
+            if (in_flat(idx << ADDR_SHIFT)) {
+                auto bit = flat_touched[idx - (flat_base >> ADDR_SHIFT)];
+                if (!bit) touched.insert(idx);
+                bit = true;
+            } else {
+                touched.insert(idx);
             }
         }
-        std::cout << std::dec;
+        // Flat pages bypass `page`, so they take over the cache entry here.
+        if (idx != c.idx) c = PageCache{this, c.epoch, idx};
+        c.touched = true;
     }
 };
 
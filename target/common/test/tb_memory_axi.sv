@@ -16,6 +16,8 @@ module tb_memory_axi #(
   parameter int unsigned AxiUserWidth  = 0,
   /// Atomic memory support.
   parameter bit unsigned ATOPSupport = 1,
+  /// Port of the DRAM timing model this memory is accessed through.
+  parameter int unsigned DramPort = 0,
   parameter type req_t = logic,
   parameter type rsp_t = logic
 )(
@@ -48,6 +50,7 @@ module tb_memory_axi #(
     .AXI_USER_WIDTH ( AxiUserWidth )
   ) axi(),
     axi_wo_atomics(),
+    axi_timed(),
     axi_wo_atomics_cut();
 
   `AXI_ASSIGN_FROM_REQ(axi, req_i)
@@ -74,6 +77,73 @@ module tb_memory_axi #(
     `ASSERT(NoAtomicOperation, axi.aw_valid & axi.aw_ready |-> (axi.aw_atop == axi_pkg::ATOP_NONE))
   end
 
+  // DRAM timing model (see `dram_model.hh`). The memory below answers
+  // immediately; requests beyond the outstanding limit are stalled and R beats
+  // and B responses are held back until the model releases them.
+  import "DPI-C" function int tb_dram_enabled();
+  import "DPI-C" function int tb_dram_can_issue(input int port, input int write);
+  import "DPI-C" function void tb_dram_request(
+    input int port, input longint cycle, input int id, input longint addr, input int beats,
+    input int size, input int write);
+  import "DPI-C" function int tb_dram_ready(
+    input int port, input longint cycle, input int id, input int write);
+  import "DPI-C" function void tb_dram_respond(input int port, input int id, input int write);
+
+  req_t dram_req, timed_req;
+  rsp_t dram_rsp, timed_rsp;
+  bit dram_timing;
+  longint dram_cycle;
+  logic ar_allow, aw_allow, r_allow, b_allow;
+
+  initial dram_timing = tb_dram_enabled() != 0;
+
+  `AXI_ASSIGN_TO_REQ(dram_req, axi_wo_atomics)
+  `AXI_ASSIGN_FROM_RESP(axi_wo_atomics, dram_rsp)
+
+  always_comb begin
+    ar_allow = 1'b1;
+    aw_allow = 1'b1;
+    r_allow = 1'b1;
+    b_allow = 1'b1;
+    if (dram_timing) begin
+      ar_allow = tb_dram_can_issue(DramPort, 0) != 0;
+      aw_allow = tb_dram_can_issue(DramPort, 1) != 0;
+      r_allow = tb_dram_ready(DramPort, dram_cycle, timed_rsp.r.id, 0) != 0;
+      b_allow = tb_dram_ready(DramPort, dram_cycle, timed_rsp.b.id, 1) != 0;
+    end
+    timed_req = dram_req;
+    dram_rsp = timed_rsp;
+    timed_req.ar_valid = dram_req.ar_valid & ar_allow;
+    dram_rsp.ar_ready = timed_rsp.ar_ready & ar_allow;
+    timed_req.aw_valid = dram_req.aw_valid & aw_allow;
+    dram_rsp.aw_ready = timed_rsp.aw_ready & aw_allow;
+    dram_rsp.r_valid = timed_rsp.r_valid & r_allow;
+    timed_req.r_ready = dram_req.r_ready & r_allow;
+    dram_rsp.b_valid = timed_rsp.b_valid & b_allow;
+    timed_req.b_ready = dram_req.b_ready & b_allow;
+  end
+
+  always_ff @(posedge clk_i or negedge rst_ni) begin
+    if (!rst_ni) begin
+      dram_cycle <= 0;
+    end else if (dram_timing) begin
+      dram_cycle <= dram_cycle + 1;
+      if (timed_req.ar_valid && timed_rsp.ar_ready) begin
+        tb_dram_request(DramPort, dram_cycle, timed_req.ar.id, timed_req.ar.addr,
+                        timed_req.ar.len + 1, 1 << timed_req.ar.size, 0);
+      end
+      if (timed_req.aw_valid && timed_rsp.aw_ready) begin
+        tb_dram_request(DramPort, dram_cycle, timed_req.aw.id, timed_req.aw.addr,
+                        timed_req.aw.len + 1, 1 << timed_req.aw.size, 1);
+      end
+      if (dram_rsp.r_valid && dram_req.r_ready) tb_dram_respond(DramPort, timed_rsp.r.id, 0);
+      if (dram_rsp.b_valid && dram_req.b_ready) tb_dram_respond(DramPort, timed_rsp.b.id, 1);
+    end
+  end
+
+  `AXI_ASSIGN_FROM_REQ(axi_timed, timed_req)
+  `AXI_ASSIGN_TO_RESP(timed_rsp, axi_timed)
+
   // Ensure the AXI interface has not feedthrough signals.
   axi_cut_intf #(
     .BYPASS     (1'b0),
@@ -84,7 +154,7 @@ module tb_memory_axi #(
   ) i_cut (
     .clk_i (clk_i),
     .rst_ni (rst_ni),
-    .in (axi_wo_atomics),
+    .in (axi_timed),
     .out (axi_wo_atomics_cut)
   );
 
@@ -0,0 +1,109 @@
+// Copyright 2024 KU Leuven.
+// Solderpad Hardware License, Version 0.51, see LICENSE for details.
+// SPDX-License-Identifier: SHL-0.51
+
+// Decode a binary hart trace (`logs/trace_hart_*.bin`) into the text format
+// the tracer in `snitch_cc.sv` writes without `SNITCH_TRACE_BINARY`, such
+// that `spike-dasm` and `util/trace/gen_trace.py` can process it as before.
+//
+// Usage: trace_decode <trace.bin> [out.dasm]
+
+#include <stdio.h>
+
+#include "hart_trace.hh"
+
+namespace {
+
+// Field names of the trace port structs in `snitch_pkg`, in order.
+const char *const SNITCH_FIELDS[] = {
+    "source", "stall", "exception", "rs1", "rs2", "rd", "is_load", "is_store",
+    "is_branch", "pc_d", "opa", "opb", "opa_select", "opb_select", "write_rd",
+    "csr_addr", "writeback", "gpr_rdata_1", "ls_size", "ld_result_32", "lsu_rd",
+    "retire_load", "alu_result", "ls_amo", "retire_acc", "acc_pid",
+    "acc_pdata_32", "fpu_offload", "is_seq_insn"};
+
+const char *const FPU_FIELDS[] = {
+    "source", "acc_q_hs", "fpu_out_hs", "lsu_q_hs", "op_in", "rs1", "rs2",
+    "rs3", "rd", "op_sel_0", "op_sel_1", "op_sel_2", "src_fmt", "dst_fmt",
+    "int_fmt", "acc_qdata_0", "acc_qdata_1", "acc_qdata_2", "op_0", "op_1",
+    "op_2", "use_fpu", "fpu_in_rd", "fpu_in_acc", "ls_size", "is_load",
+    "is_store", "lsu_qaddr", "lsu_rd", "acc_wb_ready", "fpu_out_acc",
+    "fpr_waddr", "fpr_wdata", "fpr_we"};
+
+const char *const FPU_SEQ_FIELDS[] = {
+    "source", "cbuf_push", "is_outer", "max_inst", "max_rpt", "stg_max",
+    "stg_mask"};
+
+template <size_t N>
+constexpr int count(const char *const (&)[N]) {
+    return N;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <trace.bin> [out.dasm]\n", argv[0]);
+        return 1;
+    }
+    FILE *in = fopen(argv[1], "rb");
+    if (!in) {
+        fprintf(stderr, "[trace_decode] Cannot open `%s`\n", argv[1]);
+        return 1;
+    }
+    FILE *out = argc > 2 ? fopen(argv[2], "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "[trace_decode] Cannot open `%s`\n", argv[2]);
+        return 1;
+    }
+    setvbuf(in, nullptr, _IOFBF, 1 << 20);
+    setvbuf(out, nullptr, _IOFBF, 1 << 20);
+
+    sim::HartTrace::Header h;
+    if (fread(&h, sizeof(h), 1, in) != 1 || h.magic != sim::HartTrace::MAGIC) {
+        fprintf(stderr, "[trace_decode] `%s` is not a hart trace\n", argv[1]);
+        return 1;
+    }
+
+    sim::HartTrace::Record r;
+    uint64_t fields[64];
+    while (fread(&r, sizeof(r), 1, in) == 1) {
+        int n = __builtin_popcountll(r.mask);
+        if (fread(fields, sizeof(uint64_t), n, in) != (size_t)n) break;
+        const char *const *names;
+        int num_names;
+        switch (r.source) {
+            case sim::HartTrace::SrcSnitch:
+                names = SNITCH_FIELDS;
+                num_names = count(SNITCH_FIELDS);
+                break;
+            case sim::HartTrace::SrcFpu:
+                names = FPU_FIELDS;
+                num_names = count(FPU_FIELDS);
+                break;
+            default:
+                names = FPU_SEQ_FIELDS;
+                num_names = count(FPU_SEQ_FIELDS);
+                break;
+        }
+        // Same layout as the `$sformat` in `snitch_cc.sv`. FPU events carry
+        // no PC and sequencer events no instruction, which print as `z`.
+        fprintf(out, "%20lu %lu %8u ", (unsigned long)(r.time * h.time_scale),
+                (unsigned long)r.cycle, r.priv);
+        if (r.source == sim::HartTrace::SrcSnitch)
+            fprintf(out, "0x%08x DASM(%08x)", r.pc, (uint32_t)r.insn);
+        else if (r.source == sim::HartTrace::SrcFpu)
+            fprintf(out, "0xzzzzzzzz DASM(%016lx)", (unsigned long)r.insn);
+        else
+            fprintf(out, "0xzzzzzzzz DASM(zzzzzzzzzzzzzzzz)");
+        fputs(" #; {", out);
+        for (int i = 0, j = 0; i < num_names; i++) {
+            uint64_t v = (r.mask >> i) & 1 ? fields[j++] : 0;
+            fprintf(out, "'%s': 0x%lx, ", names[i], (unsigned long)v);
+        }
+        fputs("}\n", out);
+    }
+    fclose(in);
+    if (out != stdout) fclose(out);
+    return 0;
+}
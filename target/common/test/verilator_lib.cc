@@ -6,79 +6,371 @@
 
 #include "Vtestharness.h"
 #include "Vtestharness__Dpi.h"
+#include "dram_model.hh"
 #include "sim.hh"
+#include "sim_ctrl.hh"
 #include "tb_lib.hh"
 #include "verilated.h"
+#ifdef VLT_SAVABLE
+#include "verilated_save.h"
+#endif
+#ifdef VLT_TRACE_FST
+#include "verilated_fst_c.h"
+#else
 #include "verilated_vcd_c.h"
+#endif
 namespace sim {
 
-// Number of cycles between HTIF checks.
-const int HTIFTimeInterval = 200;
+// Wave format the model was verilated for (`VLT_TRACE`).
+#ifdef VLT_TRACE_FST
+using WaveFile = VerilatedFstC;
+const char *WAVE_FILE = "sim.fst";
+#else
+using WaveFile = VerilatedVcdC;
+const char *WAVE_FILE = "sim.vcd";
+#endif
+
+// Number of cycles between HTIF checks. The interval doubles up to the
+// maximum every time the host finds tohost and fromhost idle.
+const uint64_t HTIFMinInterval = 200;
+const uint64_t HTIFMaxInterval = 200 << 5;
 
 // We want to return timestamp in picosecond accuracy, assuming that one cycle
 // takes 1ns Since 1 cycle takes 2 sim::TIME increments, scale by 500 to get
 // time = cycle * 1000 + <some constant>
 const int TIME_CYCLES_TO_TIMESTAMP = 500;
-void sim_thread_main(void *arg) { ((Sim *)arg)->main(); }
 
 // Sim time.
 vluint64_t TIME = 0;
 
+// The model, shared by all simulations of the process.
+static std::unique_ptr<Vtestharness> TOP;
+
+// The context of the clock loop, also shared by all simulations of the
+// process, and the simulation it currently runs. A finished simulation
+// leaves the context suspended, so it cannot own it.
+static context_t TARGET;
+static bool TARGET_STARTED = false;
+static Sim *ACTIVE = nullptr;
+
+// Run the simulations one after another on the shared context.
+void sim_thread_main(void *arg) {
+    do {
+        ACTIVE->main();
+    } while (!Verilated::gotFinish());
+}
+
+#ifdef VLT_SAVABLE
+// Leads the testbench state in a checkpoint, ahead of the model itself.
+const uint64_t CHECKPOINT_MAGIC = 0x54504b434e53;  // "SNCKPT"
+
+// Save the model, the sim time, all written global memory pages and the
+// state of the DRAM timing model.
+static bool save_checkpoint(const std::string &path, Vtestharness &top,
+                            bool clk_i) {
+    VerilatedSave os;
+    os.open(path);
+    if (!os.isOpen()) {
+        fprintf(stderr, "[Checkpoint] Cannot open `%s`\n", path.c_str());
+        return false;
+    }
+    uint64_t magic = CHECKPOINT_MAGIC, time = TIME;
+    std::vector<uint64_t> touched = MEM.touched_pages();
+    uint64_t num_pages = touched.size();
+    os << magic << time << clk_i << num_pages;
+    std::vector<uint8_t> page(GlobalMemory::PAGE_SIZE);
+    for (uint64_t idx : touched) {
+        MEM.read(idx << GlobalMemory::ADDR_SHIFT, page.size(), page.data());
+        os << idx;
+        os.write(page.data(), page.size());
+    }
+    DRAM.save(os);
+    os << top;
+    os.close();
+    printf("[Checkpoint] Saved cycle %lu with %lu pages to `%s`\n",
+           (unsigned long)(TIME / 2), (unsigned long)num_pages, path.c_str());
+    return true;
+}
+
+// Restore the state saved by `save_checkpoint`. Memory written since reset,
+// e.g. by the binary loader, is overwritten with the checkpointed pages.
+static bool restore_checkpoint(const std::string &path, Vtestharness &top,
+                               bool &clk_i) {
+    VerilatedRestore os;
+    os.open(path);
+    if (!os.isOpen()) {
+        fprintf(stderr, "[Checkpoint] Cannot open `%s`\n", path.c_str());
+        return false;
+    }
+    uint64_t magic, time, num_pages;
+    os >> magic;
+    if (magic != CHECKPOINT_MAGIC) {
+        fprintf(stderr, "[Checkpoint] `%s` is not a checkpoint\n",
+                path.c_str());
+        return false;
+    }
+    os >> time >> clk_i >> num_pages;
+    std::vector<uint8_t> page(GlobalMemory::PAGE_SIZE);
+    for (uint64_t i = 0; i < num_pages; i++) {
+        uint64_t idx;
+        os >> idx;
+        os.read(page.data(), page.size());
+        MEM.write(idx << GlobalMemory::ADDR_SHIFT, page.size(), page.data(),
+                  nullptr);
+    }
+    if (!DRAM.restore(os)) {
+        fprintf(stderr, "[Checkpoint] `%s` has a different DRAM model\n",
+                path.c_str());
+        return false;
+    }
+    os >> top;
+    os.close();
+    TIME = time;
+    printf("[Checkpoint] Restored cycle %lu with %lu pages from `%s`\n",
+           (unsigned long)(TIME / 2), (unsigned long)num_pages, path.c_str());
+    return true;
+}
+#else
+// Multi-threaded models cannot be serialized.
+static bool save_checkpoint(const std::string &, Vtestharness &, bool) {
+    return false;
+}
+static bool restore_checkpoint(const std::string &, Vtestharness &, bool &) {
+    return false;
+}
+#endif
+
 Sim::Sim(int argc, char **argv) : htif_t(argc, argv), ipc(argc, argv) {
-    // Search arguments for `--vcd` flag and enable waves if requested
+    static constexpr char CHECKPOINT_AT_FLAG[] = "--checkpoint-at=";
+    static constexpr char CHECKPOINT_FILE_FLAG[] = "--checkpoint-file=";
+    static constexpr char RESTORE_FLAG[] = "--restore=";
+    static constexpr char WAVE_START_FLAG[] = "--wave-start=";
+    static constexpr char WAVE_STOP_FLAG[] = "--wave-stop=";
+    static constexpr char WAVE_MARKER_FLAG[] = "--wave-marker=";
+    static constexpr char WAVE_DEPTH_FLAG[] = "--wave-depth=";
+    static constexpr char WAVE_SCOPE_FLAG[] = "--wave-scope=";
     for (auto i = 1; i < argc; ++i) {
-        if (strcmp(argv[i], "--vcd") == 0) {
-            printf("VCD wave generation enabled\n");
-            vlt_vcd = true;
+        // Waves over the whole run. `--vcd` is kept for compatibility.
+        if (strcmp(argv[i], "--waves") == 0 || strcmp(argv[i], "--vcd") == 0)
+            waves = true;
+        // Waves in a window of cycles, `[start, stop)`.
+        if (strncmp(argv[i], WAVE_START_FLAG, strlen(WAVE_START_FLAG)) == 0) {
+            wave_start = strtoull(argv[i] + strlen(WAVE_START_FLAG), 0, 0);
+            waves = true;
+        }
+        if (strncmp(argv[i], WAVE_STOP_FLAG, strlen(WAVE_STOP_FLAG)) == 0) {
+            wave_stop = strtoull(argv[i] + strlen(WAVE_STOP_FLAG), 0, 0);
+            waves = true;
         }
+        // Waves while the software keeps a word in global memory, given as
+        // address or symbol, nonzero.
+        if (strncmp(argv[i], WAVE_MARKER_FLAG, strlen(WAVE_MARKER_FLAG)) ==
+            0) {
+            wave_marker = argv[i] + strlen(WAVE_MARKER_FLAG);
+            waves = true;
+        }
+        if (strncmp(argv[i], WAVE_DEPTH_FLAG, strlen(WAVE_DEPTH_FLAG)) == 0)
+            wave_depth = atoi(argv[i] + strlen(WAVE_DEPTH_FLAG));
+        if (strncmp(argv[i], WAVE_SCOPE_FLAG, strlen(WAVE_SCOPE_FLAG)) == 0)
+            wave_scope = argv[i] + strlen(WAVE_SCOPE_FLAG);
+        // Checkpoint at a cycle, or at the first write to a symbol of the
+        // binary in global memory, e.g. a flag set once initialization is done.
+        if (strncmp(argv[i], CHECKPOINT_AT_FLAG, strlen(CHECKPOINT_AT_FLAG)) ==
+            0) {
+            const char *at = argv[i] + strlen(CHECKPOINT_AT_FLAG);
+            char *end;
+            checkpoint_cycle = strtoull(at, &end, 0);
+            if (*end != '\0' || end == at) {
+                checkpoint_cycle = 0;
+                checkpoint_marker = at;
+            }
+        }
+        if (strncmp(argv[i], CHECKPOINT_FILE_FLAG,
+                    strlen(CHECKPOINT_FILE_FLAG)) == 0)
+            checkpoint_file = argv[i] + strlen(CHECKPOINT_FILE_FLAG);
+        if (strncmp(argv[i], RESTORE_FLAG, strlen(RESTORE_FLAG)) == 0)
+            restore_file = argv[i] + strlen(RESTORE_FLAG);
+        // Wait for the IPC host before the first cycle.
+        if (strcmp(argv[i], "--paused") == 0) CTRL.request_stop();
+    }
+#ifndef VLT_SAVABLE
+    if (checkpoint_cycle || !checkpoint_marker.empty() ||
+        !restore_file.empty()) {
+        fprintf(stderr,
+                "Checkpoints require a model built with VLT_SAVABLE=1\n");
+        exit(1);
     }
+#endif
+    parse_common_args(argc, argv);
     Verilated::commandArgs(argc, argv);
 }
 
-void Sim::idle() { target.switch_to(); }
+void Sim::idle() { TARGET.switch_to(); }
 
 /// Execute the simulation.
 int Sim::run() {
     host = context_t::current();
-    target.init(sim_thread_main, this);
-    return htif_t::run();
+    ACTIVE = this;
+    if (!TARGET_STARTED) {
+        TARGET.init(sim_thread_main, nullptr);
+        TARGET_STARTED = true;
+    }
+    int ret = htif_t::run();
+    // Let the clock loop clean up, such that this simulation can be torn
+    // down and the next one run.
+    finished = true;
+    TARGET.switch_to();
+    if (htif_tohost) MEM.unwatch(htif_tohost, sizeof(uint64_t));
+    if (!wave_marker.empty()) MEM.unwatch(wave_marker_addr, sizeof(uint32_t));
+    CTRL.finish();
+    // Report the simulation speed to compare model variants.
+    std::chrono::duration<double> t =
+        std::chrono::steady_clock::now() - sim_start;
+    if (mem_stats) mem_stats->dump();
+    cycles = (TIME - sim_start_time) / 2;
+    seconds = t.count();
+    printf("[Sim] Simulated %lu cycles in %.3f s (%.1f cycles/s)\n",
+           (unsigned long)cycles, seconds, cycles / seconds);
+    return ret;
 }
 
 void Sim::main() {
     // Initialize verilator environment.
     Verilated::traceEverOn(true);
-    // Allocate the simulation state and VCD trace.
-    auto top = std::make_unique<Vtestharness>();
-    auto vcd = std::make_unique<VerilatedVcdC>();
+    // Allocate the simulation state and wave file. The model is kept across
+    // simulations, such that batch mode runs all binaries on one model.
+    if (!TOP) TOP = std::make_unique<Vtestharness>();
+    Vtestharness *top = TOP.get();
+    auto wave = std::make_unique<WaveFile>();
+
+    bool clk_i = top->clk_i, rst_ni = 0;
 
-    bool clk_i = 0, rst_ni = 0;
+    // Resume from a checkpoint instead of reset if requested.
+    if (!restore_file.empty() && !restore_checkpoint(restore_file, *top, clk_i))
+        exit(1);
 
-    // Trace 8 levels of hierarchy.
-    if (vlt_vcd) {
-        top->trace(vcd.get(), 8);
-        vcd->open("sim.vcd");
-        vcd->dump(TIME);
+    // Hold the DUT in reset for a few cycles, also between the binaries of a
+    // batch, unless a checkpoint was restored.
+    uint64_t reset_end = restore_file.empty() ? TIME + 8 : 0;
+    if (restore_file.empty()) TIME += 2;
+
+    // The wave file is only opened once the window first opens, such that no
+    // tracing cost is paid before.
+    bool wave_open = false;
+    uint64_t wave_marker_gen = 0;
+    bool wave_marker_set = wave_marker.empty();
+    if (!wave_marker.empty()) {
+        char *end;
+        wave_marker_addr = strtoull(wave_marker.c_str(), &end, 0);
+        if (*end != '\0' && !elf_symbol(wave_marker, wave_marker_addr)) {
+            fprintf(stderr, "[Waves] Unknown symbol `%s`\n",
+                    wave_marker.c_str());
+            exit(1);
+        }
+        // Check the marker every cycle, but only read it after a write.
+        wave_marker_gen = MEM.watch_generation() - 1;
+        MEM.watch(wave_marker_addr, sizeof(uint32_t));
+    }
+
+    // Arm the checkpoint marker by watching writes to its symbol.
+    bool checkpoint = checkpoint_cycle || !checkpoint_marker.empty();
+    uint64_t marker_addr = 0, marker_gen = 0;
+    if (!checkpoint_marker.empty()) {
+        if (!elf_symbol(checkpoint_marker, marker_addr)) {
+            fprintf(stderr, "[Checkpoint] Unknown symbol `%s`\n",
+                    checkpoint_marker.c_str());
+            exit(1);
+        }
+        marker_gen = MEM.watch_generation();
+        MEM.watch(marker_addr, 1);
     }
-    TIME += 2;
+
+    // Check HTIF as soon as the binary writes tohost, such that its exit does
+    // not wait out the back-off interval and inflate the simulated cycles.
+    uint64_t tohost_gen = MEM.watch_generation();
+    if (elf_symbol("tohost", htif_tohost))
+        MEM.watch(htif_tohost, sizeof(uint64_t));
+    else
+        htif_tohost = 0;
+
+    uint64_t htif_interval = HTIFMinInterval;
+    uint64_t next_htif = TIME + htif_interval;
+    // The IPC host may pause the loop and save checkpoints while paused.
+    CTRL.attach([] { return (uint64_t)TIME; });
+    CTRL.checkpoint = [&](const std::string &path) {
+        return save_checkpoint(path, *top, clk_i);
+    };
+
+    sim_start_time = TIME;
+    sim_start = std::chrono::steady_clock::now();
 
     while (!Verilated::gotFinish()) {
         clk_i = !clk_i;
-        rst_ni = TIME >= 8;
+        rst_ni = TIME >= reset_end;
         top->clk_i = clk_i;
         top->rst_ni = rst_ni;
         // Evaluate the DUT.
         top->eval();
-        if (vlt_vcd) vcd->dump(TIME);
+        if (waves) {
+            if (!wave_marker.empty() &&
+                MEM.watch_generation() != wave_marker_gen) {
+                wave_marker_gen = MEM.watch_generation();
+                uint32_t marker;
+                MEM.read(wave_marker_addr, sizeof(marker), (uint8_t *)&marker);
+                wave_marker_set = marker != 0;
+            }
+            if (wave_marker_set && TIME / 2 >= wave_start &&
+                TIME / 2 < wave_stop) {
+                if (!wave_open) {
+                    top->trace(wave.get(), wave_depth);
+                    if (!wave_scope.empty())
+                        wave->dumpvars(wave_depth, wave_scope);
+                    wave->open(WAVE_FILE);
+                    wave_open = true;
+                    printf("[Waves] Writing `%s` from cycle %lu\n", WAVE_FILE,
+                           (unsigned long)(TIME / 2));
+                }
+                wave->dump(TIME);
+            }
+        }
         // Increase global time.
         TIME++;
-        // Switch to the HTIF interface in regular intervals.
-        if (TIME % HTIFTimeInterval == 0) {
+        // Checkpoint between cycles, once the clock has fallen.
+        if (checkpoint && !clk_i &&
+            (checkpoint_marker.empty()
+                 ? TIME / 2 >= checkpoint_cycle
+                 : MEM.watch_generation() != marker_gen)) {
+            save_checkpoint(checkpoint_file, *top, clk_i);
+            if (!checkpoint_marker.empty()) MEM.unwatch(marker_addr, 1);
+            checkpoint = false;
+        }
+        // Hand over to the IPC host at breakpoints or when it asks to pause.
+        if (CTRL.enabled && !clk_i) CTRL.tick(TIME / 2);
+        // Switch to the HTIF interface in regular intervals, backing off
+        // while the host has nothing to do, and right away once tohost was
+        // written.
+        if (htif_tohost && MEM.watch_generation() != tohost_gen) {
+            tohost_gen = MEM.watch_generation();
+            htif_interval = HTIFMinInterval;
+            next_htif = TIME;
+        }
+        if (TIME >= next_htif) {
+            htif_active = false;
             host->switch_to();
+            if (finished) break;
+            htif_interval = htif_active
+                                ? HTIFMinInterval
+                                : std::min(2 * htif_interval, HTIFMaxInterval);
+            next_htif = TIME + htif_interval;
         }
     }
 
-    // Clean up.
-    if (vlt_vcd) vcd->close();
+    // Clean up, and hand back to the host. The next simulation resumes the
+    // clock loop from here.
+    if (checkpoint && !checkpoint_marker.empty()) MEM.unwatch(marker_addr, 1);
+    if (wave_open) wave->close();
+    wave.reset();
+    if (!Verilated::gotFinish()) host->switch_to();
 }
 }  // namespace sim
 
@@ -91,6 +383,8 @@ void tb_memory_read(long long addr, int len, const svOpenArrayHandle data) {
     //           << " bytes)\n";
     void *data_ptr = svGetArrayPtr(data);
     assert(data_ptr);
+    if (sim::MEM_TRACE) sim::MEM_TRACE->read(addr, len);
+    if (sim::MEM_STATS) sim::MEM_STATS->read(sim::TIME / 2, addr, len);
     sim::MEM.read(addr, len, (uint8_t *)data_ptr);
 }
 
@@ -102,21 +396,11 @@ void tb_memory_write(long long addr, int len, const svOpenArrayHandle data,
     const void *strb_ptr = svGetArrayPtr(strb);
     assert(data_ptr);
     assert(strb_ptr);
+    if (sim::MEM_TRACE)
+        sim::MEM_TRACE->write(addr, len, (const uint8_t *)data_ptr,
+                              (const uint8_t *)strb_ptr);
+    if (sim::CTRL.enabled) sim::CTRL.check_write(addr, len);
+    if (sim::MEM_STATS) sim::MEM_STATS->write(sim::TIME / 2, addr, len);
     sim::MEM.write(addr, len, (const uint8_t *)data_ptr,
                    (const uint8_t *)strb_ptr);
 }
-
-const long long clint_addr = sim::BOOTDATA.clint_base;
-const long num_cores = sim::BOOTDATA.core_count;
-
-void clint_tick(const svOpenArrayHandle msip) {
-    uint8_t *msip_ptr = (uint8_t *)svGetArrayPtr(msip);
-    assert(msip_ptr);
-    uint32_t read_val;
-    for (int i = 0; i < num_cores; i++) {
-        if (i % 32 == 0)
-            sim::MEM.read(clint_addr + i / 32, sizeof(uint32_t),
-                          (uint8_t *)&read_val);
-        msip_ptr[i] = (read_val & (1 << (i % 32))) != 0 ? 1 : 0;
-    }
-}
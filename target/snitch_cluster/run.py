@@ -24,7 +24,8 @@ SIMULATORS = {
 
 def main():
     args = parser('vsim', SIMULATORS.keys()).parse_args()
-    simulations = get_simulations(args.testlist, SIMULATORS[args.simulator])
+    simulations = get_simulations(args.testlist, SIMULATORS[args.simulator],
+                                  batch_size=args.batch_size)
     return run_simulations(simulations,
                            n_procs=args.n_procs,
                            run_dir=Path(args.run_dir),
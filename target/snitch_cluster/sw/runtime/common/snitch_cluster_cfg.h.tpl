@@ -3,4 +3,6 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #define CFG_CLUSTER_NR_CORES ${cfg['cluster']['nr_cores']}
-#define CFG_CLUSTER_BASE_HARTID ${cfg['cluster']['cluster_base_hartid']}
\ No newline at end of file
+#define CFG_CLUSTER_BASE_HARTID ${cfg['cluster']['cluster_base_hartid']}
+#define CFG_CLUSTER_TCDM_BANKS ${cfg['cluster']['tcdm']['banks']}
+#define CFG_CLUSTER_TCDM_BANK_WIDTH ${cfg['cluster']['data_width'] // 8}
@@ -13,6 +13,8 @@
 #define SNRT_CLUSTER_DM_CORE_NUM 1
 #define SNRT_TCDM_START_ADDR CLUSTER_TCDM_BASE_ADDR
 #define SNRT_TCDM_SIZE (CLUSTER_PERIPH_BASE_ADDR - CLUSTER_TCDM_BASE_ADDR)
+#define SNRT_TCDM_BANK_NUM CFG_CLUSTER_TCDM_BANKS
+#define SNRT_TCDM_BANK_WIDTH CFG_CLUSTER_TCDM_BANK_WIDTH
 #define SNRT_CLUSTER_OFFSET 0
 #define SNRT_CLUSTER_HW_BARRIER_ADDR \
     (CLUSTER_PERIPH_BASE_ADDR + SNITCH_CLUSTER_PERIPHERAL_HW_BARRIER_REG_OFFSET)
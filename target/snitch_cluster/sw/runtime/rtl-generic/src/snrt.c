@@ -9,10 +9,13 @@
 #include "cluster_interrupts.c"
 // #include "dm.c"
 #include "dma.c"
+#include "dma_pipe.c"
 #include "eu.c"
 // #include "kmp.c"
 // #include "omp.c"
 #include "printf.c"
+#include "prof.c"
+#include "reduce.c"
 #include "putchar.c"
 #include "snitch_cluster_start.c"
 #include "sync.c"
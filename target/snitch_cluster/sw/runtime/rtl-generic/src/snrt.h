@@ -14,6 +14,9 @@
 // Forward declarations
 #include "alloc_decls.h"
 #include "cls_decls.h"
+#include "dma_decls.h"
+#include "dma_pipe_decls.h"
+#include "prof_decls.h"
 #include "riscv_decls.h"
 #include "start_decls.h"
 #include "sync_decls.h"
@@ -25,14 +28,18 @@
 #include "cluster_interrupts.h"
 // #include "dm.h"
 #include "dma.h"
+#include "dma_pipe.h"
 #include "dump.h"
 #include "eu.h"
 // #include "kmp.h"
 // #include "omp.h"
 #include "perf_cnt.h"
 #include "printf.h"
+#include "prof.h"
 #include "riscv.h"
 #include "snitch_cluster_global_interrupts.h"
 // #include "ssr.h"
+// Scalar kernels in place of reduce.h
+#include "reduce_generic.h"
 #include "sync.h"
 #include "team.h"
@@ -9,7 +9,7 @@
 # Invocation options #
 ######################
 
-DEBUG ?= OFF # ON to turn on debugging symbols
+DEBUG ?= OFF # ON to turn on debugging symbols and runtime checks
 
 ###################
 # Build variables #
@@ -59,6 +59,7 @@ RISCV_CFLAGS += -ftls-model=local-exec
 RISCV_CFLAGS += -O3
 ifeq ($(DEBUG), ON)
 RISCV_CFLAGS += -g
+RISCV_CFLAGS += -DSNRT_DEBUG
 endif
 # Required by math library to avoid conflict with stdint definition
 RISCV_CFLAGS += -D__DEFINED_uint64_t
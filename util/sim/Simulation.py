@@ -9,6 +9,7 @@ from pathlib import Path
 import subprocess
 import re
 import os
+import json
 from mako.template import Template
 
 
@@ -99,6 +100,73 @@ class VerilatorSimulation(RTLSimulation):
         return self.process.returncode
 
 
+class VerilatorBatchSimulation(Simulation):
+    """Runs several Verilator simulations in a single process.
+
+    The binaries are listed in a file passed to the simulator with `--batch`,
+    which reports the exit code of every binary in a summary file, a JSON
+    array with the object of every binary on a line of its own.
+    """
+
+    LIST_FILE = 'batch.txt'
+    SUMMARY_FILE = 'batch.json'
+
+    def __init__(self, sims, name='batch', sim_bin=None):
+        super().__init__(name)
+        self.sims = sims
+        self.cmd = [str(sim_bin), f'--batch={self.LIST_FILE}',
+                    f'--batch-summary={self.SUMMARY_FILE}']
+        self.results = None
+
+    def launch(self, run_dir=None, dry_run=False):
+        if not run_dir:
+            run_dir = Path.cwd()
+        self.summary = run_dir / self.SUMMARY_FILE
+        if not dry_run:
+            os.makedirs(run_dir, exist_ok=True)
+            with open(run_dir / self.LIST_FILE, 'w') as f:
+                f.writelines(f'{sim.elf}\n' for sim in self.sims)
+        cprint(f'Run batch of {len(self.sims)} tests:', attrs=["bold"])
+        for sim in self.sims:
+            print(f'  {colored(sim.elf, "cyan")}')
+        super().launch(run_dir, dry_run)
+
+    def get_results(self):
+        # Parse the summary line by line, such that the binaries which
+        # completed are reported even if the simulator crashed later on
+        results = {}
+        try:
+            with open(self.summary, 'r') as f:
+                for line in f.readlines():
+                    line = line.strip().rstrip(',')
+                    if line.startswith('{'):
+                        result = json.loads(line)
+                        results[result['elf']] = result['exit_code']
+        except FileNotFoundError:
+            pass
+        return results
+
+    def successful(self):
+        if self.results is None:
+            self.results = self.get_results()
+        for sim in self.sims:
+            sim.actual_retcode = self.results.get(str(sim.elf))
+        return all(sim.actual_retcode is not None and
+                   int(sim.actual_retcode) == int(sim.expected_retcode) for sim in self.sims)
+
+    def print_status(self):
+        if not self.completed():
+            return super().print_status()
+        self.successful()
+        for sim in self.sims:
+            if sim.actual_retcode is None:
+                cprint(f'{sim.elf} test did not run', 'red', attrs=['bold'], flush=True)
+            elif int(sim.actual_retcode) == int(sim.expected_retcode):
+                cprint(f'{sim.elf} test passed', 'green', attrs=['bold'], flush=True)
+            else:
+                cprint(f'{sim.elf} test failed', 'red', attrs=['bold'], flush=True)
+
+
 class QuestaVCSSimulation(RTLSimulation):
 
     def get_retcode(self):
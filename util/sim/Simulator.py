@@ -5,7 +5,7 @@
 # Luca Colagrande <colluca@iis.ee.ethz.ch>
 
 from Simulation import QuestaSimulation, VCSSimulation, VerilatorSimulation, BansheeSimulation, \
-                       CustomSimulation
+                       CustomSimulation, VerilatorBatchSimulation
 
 
 class Simulator(object):
@@ -55,6 +55,9 @@ class VerilatorSimulator(RTLSimulator):
     def __init__(self, binary):
         super().__init__('verilator', VerilatorSimulation, binary)
 
+    def get_batch_simulation(self, sims, name):
+        return VerilatorBatchSimulation(sims, name, sim_bin=self.binary)
+
 
 class BansheeSimulator(Simulator):
 
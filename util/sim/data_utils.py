@@ -55,6 +55,25 @@ def format_ifdef_wrapper(macro, body):
     return s
 
 
+# Struct format characters of C types, for binary blobs
+CTYPE_FORMATS = {
+    'double': 'd', 'float': 'f',
+    'int8_t': 'b', 'uint8_t': 'B', 'char': 'B',
+    'int16_t': 'h', 'uint16_t': 'H',
+    'int32_t': 'i', 'uint32_t': 'I',
+    'int64_t': 'q', 'uint64_t': 'Q',
+}
+
+
+# Write vectors as a little-endian binary blob, e.g. to map into the simulated
+# memory with `--map=<addr>=<file>` instead of baking them into the binary
+def write_binary_blob(path, type, *vectors):
+    fmt = CTYPE_FORMATS[type]
+    with open(path, 'wb') as f:
+        for vector in vectors:
+            f.write(struct.pack(f'<{len(vector)}{fmt}', *vector))
+
+
 # bytearray assumed little-endian
 def bytes_to_doubles(byte_array):
     double_size = struct.calcsize('d')  # Size of a double in bytes
@@ -12,6 +12,7 @@ import time
 import yaml
 import signal
 import psutil
+from Simulation import CustomSimulation
 
 POLL_PERIOD = 0.2
 
@@ -55,6 +56,14 @@ def parser(default_simulator='vsim', simulator_choices=['vsim']):
         help=('Maximum number of tests to run in parallel. '
               'One if the option is not present. Equal to the number of CPU cores '
               'if the option is present but not followed by an argument.'))
+    parser.add_argument(
+        '--batch',
+        action='store',
+        dest='batch_size',
+        type=int,
+        default=1,
+        help=('Run up to this many tests in a single simulator process, where the '
+              'simulator supports it. Tests with a custom command always run alone.'))
     return parser
 
 
@@ -80,7 +89,7 @@ def resolve_relative_path(base_path, s):
 
 
 # Create simulation objects from a test list file
-def get_simulations(testlists, simulator):
+def get_simulations(testlists, simulator, batch_size=1):
     # Get tests from test list file
     all_tests = []
     for testlist in testlists:
@@ -99,6 +108,13 @@ def get_simulations(testlists, simulator):
         all_tests.extend(tests)
     # Create simulation object for every test which supports the specified simulator
     simulations = [simulator.get_simulation(test) for test in all_tests if simulator.supports(test)]
+    # Group the tests into batches, if the simulator supports it
+    if batch_size > 1 and hasattr(simulator, 'get_batch_simulation'):
+        batchable = [sim for sim in simulations if not isinstance(sim, CustomSimulation)]
+        simulations = [sim for sim in simulations if isinstance(sim, CustomSimulation)]
+        for i in range(0, len(batchable), batch_size):
+            batch = batchable[i:i + batch_size]
+            simulations.append(simulator.get_batch_simulation(batch, f'batch{i // batch_size}'))
     return simulations
 
 
@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+# Copyright 2024 KU Leuven.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+#
+# This script decodes the records of the snRuntime region profiler
+# (`snrt_prof_begin`/`snrt_prof_end`) into a CSV with one line per region and
+# hart, to inspect alongside the CSV produced by `perf_csv.py`.
+#
+# The records are written to the `snrt_prof_buffer` symbol in L3, which is not
+# loaded from the binary. To retrieve them, back the buffer by a file:
+#
+#   prof_csv.py map sw.elf logs/prof.bin
+#   bin/snitch_cluster.vlt sw.elf --map=<addr>=logs/prof.bin:rw
+#   prof_csv.py decode logs/prof.bin -o logs/prof.csv
+#
+# where the first command creates the file and prints the `--map` argument.
+# The cycles of a region on its hart (`mcycle`) and its events are averaged
+# over the instances of the region on the hart. Events of event groups beyond
+# the first are only counted in the runs of the region with that group
+# selected.
+
+import sys
+import argparse
+import struct
+from pathlib import Path
+import pandas as pd
+
+sys.path.append(str(Path(__file__).parent / '../sim/'))
+from elf import Elf  # noqa: E402
+
+
+SYMBOL = 'snrt_prof_buffer'
+MAGIC = 0x464f5250
+HEADER = struct.Struct('<6I')
+RECORD = struct.Struct('<12sHBBI')
+NUM_COUNTERS = 16
+
+# Must match with `enum snrt_perf_cnt_type` in `perf_cnt.h`
+EVENTS = [
+    'cycles', 'tcdm_accessed', 'tcdm_congested', 'issue_fpu', 'issue_fpu_seq',
+    'issue_core_to_fpu', 'retired_instr', 'retired_load', 'retired_i', 'retired_acc',
+    'dma_aw_stall', 'dma_ar_stall', 'dma_r_stall', 'dma_w_stall', 'dma_buf_w_stall',
+    'dma_buf_r_stall', 'dma_aw_done', 'dma_aw_bw', 'dma_ar_done', 'dma_ar_bw',
+    'dma_r_done', 'dma_r_bw', 'dma_w_done', 'dma_w_bw', 'dma_b_done', 'dma_busy',
+    'icache_miss', 'icache_hit', 'icache_prefetch', 'icache_double_hit',
+    'icache_stall'
+]
+
+# Events counted for the hart selected in the counter
+HART_LOCAL_EVENTS = set(range(3, 10)) | set(range(26, 31))
+
+
+def event_name(event_type, hart):
+    name = EVENTS[event_type] if event_type < len(EVENTS) else f'event{event_type}'
+    return f'{name}_{hart}' if event_type in HART_LOCAL_EVENTS else name
+
+
+def decode(buf):
+    magic, max_events, num_events, capacity, used, dropped = HEADER.unpack_from(buf)
+    if magic != MAGIC:
+        raise ValueError('Profiler buffer not initialized, was snrt_prof_init called?')
+    events = [struct.unpack_from('<BB', buf, HEADER.size + 2 * i)
+              for i in range(num_events)]
+    names = [event_name(*event) for event in events]
+    data = (HEADER.size + 2 * max_events + 3) & ~3
+    end = data + min(used, capacity)
+
+    records = []
+    offset = data
+    while offset + RECORD.size <= end:
+        name, hart, group, closed, cycles = RECORD.unpack_from(buf, offset)
+        if not name[0]:
+            break
+        first = group * NUM_COUNTERS
+        num = max(0, min(NUM_COUNTERS, num_events - first))
+        counters = struct.unpack_from(f'<{num}I', buf, offset + RECORD.size)
+        offset += RECORD.size + 4 * num
+        if not closed:
+            continue
+        record = {'region': name.rstrip(b'\0').decode(errors='replace'),
+                  'hart': hart, 'mcycle': cycles}
+        record.update(zip(names[first:first + num], counters))
+        records.append(record)
+    return records, dropped
+
+
+def main():
+    # Argument parsing
+    parser = argparse.ArgumentParser()
+    subparsers = parser.add_subparsers(dest='command', required=True)
+    map_parser = subparsers.add_parser(
+        'map',
+        help='Create a file to back the profiler buffer of a binary')
+    map_parser.add_argument(
+        'elf',
+        help='Binary linked with the snRuntime')
+    map_parser.add_argument(
+        'bin',
+        help='File to create')
+    decode_parser = subparsers.add_parser(
+        'decode',
+        help='Decode a profiler buffer into a CSV')
+    decode_parser.add_argument(
+        'bin',
+        help='Profiler buffer written by a simulation')
+    decode_parser.add_argument(
+        '-o',
+        '--output',
+        metavar='<csv>',
+        nargs='?',
+        default='prof.csv',
+        help='Output CSV file')
+    args = parser.parse_args()
+
+    if args.command == 'map':
+        elf = Elf(args.elf)
+        address = elf.get_symbol_address(SYMBOL)
+        size = elf.get_symbol_size(SYMBOL)
+        with open(args.bin, 'wb') as f:
+            f.truncate(size)
+        print(f'--map={address:#x}={args.bin}:rw')
+        return 0
+
+    with open(args.bin, 'rb') as f:
+        records, dropped = decode(f.read())
+    if dropped:
+        print(f'Warning: {dropped} regions did not fit into the profiler buffer',
+              file=sys.stderr)
+
+    # Average every metric over the instances of a region on a hart
+    df = pd.DataFrame.from_records(records)
+    if df.empty:
+        df = pd.DataFrame(columns=['region', 'hart', 'calls', 'mcycle'])
+    else:
+        calls = df.groupby(['region', 'hart'], sort=False).size().rename('calls')
+        df = df.groupby(['region', 'hart'], sort=False).mean()
+        df.insert(0, 'calls', calls)
+        df = df.reset_index()
+    df.to_csv(args.output, index=False)
+
+
+if __name__ == '__main__':
+    sys.exit(main())